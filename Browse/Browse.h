@@ -19,11 +19,24 @@
 *
 * Build Process:
 * ---------------
-* - Required files: Browse.h,Browse.cpp,Process.h,XmlDocument,DateTime
+* - Required files: Browse.h,Browse.cpp,Process.h,XmlDocument,DateTime,Logger.h,Logger.cpp
 * - Compiler command: devenv Project2.sln /rebuild debug
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.2 : 17th October 2026
+*  - browseFile pages by the last key of the previous page instead of by offset,
+*    and ends a page with the key to pass for the next one
+*  - paged responses leave out the no-parent list, full listings get it from
+*    one pass over the parent index
+*  - an empty page, e.g., for a limit of 0, has no next page marker
+*  - full listings of large repositories are scanned in parallel
+*  ver 2.1 : 17th October 2026
+*  - no-parent keys found through the db's parent index instead of a query per key
+*  - browseFile accepts offset and limit to return one page of files
+*  - browseFile and displayFile read records in place and never add missing keys
+*  - browseFile sends its progress, and the db at trace level, to the Diagnostics
+*    logger instead of std::cout
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th March 2018
@@ -35,6 +48,8 @@
 #include "../PayLoad/PayLoad.h"
 #include "../Process/Process.h"
 #include "../Query/Query.h"
+#include "../CppCommWithFileXfer/Logger/Logger.h"
+#include <sstream>
 
 #include <stdio.h>  /* defines FILENAME_MAX */
 #define WINDOWS  /* uncomment this line to use it for windows.*/ 
@@ -55,7 +70,8 @@ namespace Repository {
 	class Browse {
 	public:
 		static void identify(std::ostream& out = std::cout);
-		std::vector<std::string> browseFile(const Key& fileName, DbCore<T>& db_);
+		std::vector<std::string> browseFile(const Key& fileName, DbCore<T>& db_,
+			const Key& after = "", size_t limit = Cursor<T>::noLimit);
 		void displayFile(const Key& fileName, DbCore<T>& db_);
 	};
 	//----< helper function to idetify files>---------------------------
@@ -79,7 +95,10 @@ namespace Repository {
 	{
 		Process p;
 		p.title("Viewing file called " + fileName);
-		DbElement<T> dbEle = db_[fileName];
+		DbElement<T> dbEle;
+		typename DbCore<T>::iterator iter = db_.find(fileName);
+		if (iter != db_.end())
+			dbEle = iter->second;
 		PayLoad pl = dbEle.payLoad();
 		std::string appPath = "c:/windows/system32/notepad.exe";
 		p.application(appPath);
@@ -101,24 +120,41 @@ namespace Repository {
 		
 	}
 	//----< helper function to browse repository>---------------------------
+	/*
+	*  - after and limit select one page of the matching files, in key order,
+	*    so the query stops scanning once the page is full
+	*  - a full page ends with "next page after" and the key to pass as after
+	*    for the next page, which stays correct while files are checked in
+	*  - only an unpaged listing ends with the files that have no parents
+	*  - an unpaged listing of a large db scans key ranges on the shared
+	*    ThreadPool, a paged one scans in order until its page is full
+	*/
 	template <typename T>
-	std::vector<std::string> Browse<T>::browseFile(const Key& fileName, DbCore<T>& db_)
+	std::vector<std::string> Browse<T>::browseFile(const Key& fileName, DbCore<T>& db_,
+		const Key& after, size_t limit)
 	{
-		showDb(db_);
-		std::cout << "\n\nTrying to browse the child of given file" << endl;
-		DbElement<PayLoad> ele = db_[fileName];
-		Children children = ele.children();
-		std::cout << "\nBuilding the query to retrieve the description of the children" << endl;
+		if (Diagnostics::enabled(Logger::trace)) {
+			std::ostringstream out;
+			showDb(db_, out);
+			Diagnostics::write(Logger::trace, out.str());
+		}
+		LOG_WRITE(Diagnostics, Logger::debug, "\n\nTrying to browse the child of given file\n");
+		Children children;
+		typename DbCore<T>::iterator found = db_.find(fileName);
+		if (found != db_.end())
+			children = found->second.children();
+		LOG_WRITE(Diagnostics, Logger::debug, "\nBuilding the query to retrieve the description of the children\n");
 		Query<PayLoad> q1(db_);
 		Keys keys{ children };
 		Conditions<PayLoad> conds0;
 		conds0.description("This*");
-		q1.select(conds0);
+		if (after != "")
+			q1.after(after);
+		q1.parallel().limit(limit).select(conds0);
 		Keys keys2 = q1.keys();
 		std::vector<std::string> categories;
 		for (auto key : keys2) {
-			DbElement<PayLoad> dbEle = db_[key];
-			Children child = dbEle.children();
+			Children child = db_.find(key)->second.children();
 			std::string childInfo;
 			if (child.size() > 0) {
 				for (auto ch : child) {
@@ -132,19 +168,16 @@ namespace Repository {
 				temp = key.substr(0, key.find_last_of(".")) + "--" + "No child";
 			categories.push_back(temp);
 		}
-		std::cout << "\nDemonstrating: Display all of the files in any category that have no parents";
-		std::cout << "\n I am demonstrating this requirement by checking whether a key is child of another key via running a query on database";
-		std::vector<std::string> keys3 = db_.keys();
-		std::vector<std::string> noParentKeys;
-		for (string key : keys3) {
-			Query<PayLoad> q2(db_);
-			Keys keys4{ key };
-			Conditions<PayLoad> conds1;
-			conds1.children(keys4);
-			Query<PayLoad> result = q2.select(conds1);
-			if (result.keys().size() == 0)
-				noParentKeys.push_back(key);
+		if (limit != Cursor<T>::noLimit || after != "") {
+			if (!keys2.empty() && keys2.size() == limit) {
+				categories.push_back("next page after");
+				categories.push_back(keys2.back());
+			}
+			return categories;
 		}
+		LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating: Display all of the files in any category that have no parents",
+			"\n I am demonstrating this requirement by merging the db's keys with its parent index");
+		Keys noParentKeys = db_.roots();
 		categories.push_back("No parent keys");
 		std::string noParentList;
 		for (auto key : noParentKeys)
@@ -20,11 +20,15 @@
 *
 * Build Process:
 * ---------------
-* - Required files: CheckIn.h,CheckIn.cpp,DbCore.h,Version.h,XMLDocument,DateTime
+* - Required files: CheckIn.h,CheckIn.cpp,DbCore.h,Version.h,XMLDocument,DateTime,Logger.h,Logger.cpp
 * - Compiler command: devenv Project2.sln /rebuild debug
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.1 : 17th October 2026
+*  - records that are only read are looked up with find, so a
+*    VersionedDb transaction sees them as unchanged
+*  - progress messages go to the Diagnostics logger instead of std::cout
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th March 2018
@@ -36,6 +40,7 @@
 
 #include "../DbCore/DbCore.h"
 #include "../FileSystem/FileSystem.h"
+#include "../CppCommWithFileXfer/Logger/Logger.h"
 #include <stdio.h>  /* defines FILENAME_MAX */
 #define WINDOWS  /* uncomment this line to use it for windows.*/ 
 #ifdef WINDOWS
@@ -126,8 +131,9 @@ namespace Repository
 			if (fileVersion == 0)
 				fileVersion = 1;
 			std::string temp = child;
-			if (db_.contains(temp.append(".").append(to_string(fileVersion)))) {
-				Children childChilds = db_[child.append(".").append(to_string(fileVersion))].children();
+			typename DbCore<T>::iterator iter = db_.find(temp.append(".").append(to_string(fileVersion)));
+			if (iter != db_.end()) {
+				Children childChilds = iter->second.children();
 				for (auto childChild : childChilds) {
 					if (childChild.compare(key_) == 0)
 						return true;
@@ -139,7 +145,7 @@ namespace Repository
 	//----< helper function to convert files>---------------------------
 	template<typename T>
 	bool CheckIn<T>::copyAFileForCheckIn(std::string filename, size_t version, DbElement<T>& dbElem) {
-		std::cout << "\ncopying a file internally";
+		LOG_WRITE(Diagnostics, Logger::debug, "\ncopying a file internally");
 		PayLoad p = dbElem.payLoad();
 		std::string path = p.value();
 
@@ -170,9 +176,9 @@ namespace Repository
 			if (db_.contains(ch.append(".").append(to_string(fileVer+1))))
 				return false;
 
-			if (db_.contains(ch.append(".").append(to_string(fileVer)))) {
-				DbElement<T> dbele = db_[ch.append(".").append(to_string(fileVer))];
-				if (!dbele.payLoad().isClose())
+			typename DbCore<T>::iterator iter = db_.find(ch.append(".").append(to_string(fileVer)));
+			if (iter != db_.end()) {
+				if (!iter->second.payLoad().isClose())
 					return false;
 			}
 			
@@ -182,10 +188,9 @@ namespace Repository
 	//----< helper function to update DB with new check in>---------------------------
 	template<typename T>
 	void CheckIn<T>::updateDB(string newKey, DbElement<T>& ele, DbCore<T>& db_) {
-		DbElement<T> temp;
-		if (db_.contains(newKey)) {
-			temp = db_[newKey];
-			if (temp.name().compare(ele.name()) == 0) {
+		typename DbCore<T>::iterator iter = db_.find(newKey);
+		if (iter != db_.end()) {
+			if (iter->second.name().compare(ele.name()) == 0) {
 				db_[newKey] = ele;
 			}
 		}
@@ -17,11 +17,15 @@
 *
 * Build Process:
 * ---------------
-* - Required files: CheckOut.h,CheckOut.cpp,DbCore,Version.h,FileSystem.h,FileSystem.cpp,DbCore,DateTime
+* - Required files: CheckOut.h,CheckOut.cpp,DbCore,Version.h,FileSystem.h,FileSystem.cpp,DbCore,DateTime,
+*                   Logger.h,Logger.cpp
 * - Compiler command: devenv Project2.sln /rebuild debug
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.1 : 17th October 2026
+*  - child records looked up with find, so read-only snapshots can be checked out
+*  - missing source files reported to the Diagnostics logger instead of std::cout
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th March 2018
@@ -35,6 +39,7 @@
 #include "../DbCore/DbCore.h"
 #include "../PayLoad/PayLoad.h"
 #include "../FileSystem/FileSystem.h"
+#include "../CppCommWithFileXfer/Logger/Logger.h"
 
 
 using namespace NoSqlDb;
@@ -71,7 +76,10 @@ namespace Repository
 			return;
 		}
 		tempResultSet.push_back(filename);
-		DbElement<T> temp = db_[filename];
+		DbElement<T> temp;
+		typename DbCore<T>::iterator iter = db_.find(filename);
+		if (iter != db_.end())
+			temp = iter->second;
 		Children children = temp.children();
 		size_t i = 0;
 		while (children.size() > i)
@@ -93,12 +101,12 @@ namespace Repository
 		bool srcStatus = File::exists(source);
 		if (srcStatus == false)
 		{
-			std::cout << "\nSource file doesn't exist";
+			LOG_WRITE(Diagnostics, Logger::warning, "\nSource file doesn't exist");
 			return;
 		}
 		else if (destination.empty())
 		{
-			std::cout << "\nSource file doesn't exist";
+			LOG_WRITE(Diagnostics, Logger::warning, "\nSource file doesn't exist");
 			return;
 		}
 		else
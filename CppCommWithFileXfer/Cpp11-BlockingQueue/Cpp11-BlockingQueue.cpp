@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.cpp - Thread-safe Blocking Queue      //
-// ver 1.3                                                   //
+// ver 1.5                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2013 //
 ///////////////////////////////////////////////////////////////
 
@@ -11,7 +11,9 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include "Cpp11-BlockingQueue.h"
+#include "Cpp11-MpscQueue.h"
 
 #ifdef TEST_BLOCKINGQUEUE
 
@@ -76,6 +78,47 @@ int main()
   std::cout << "\n    q.size() = " << q.size();
   std::cout << "\n    q3.size() = " << q3.size();
   std::cout << "\n    q3 element = " << q3.deQ() << "\n";
+  std::cout << "\n  Dequeuing with timeout";
+  std::cout << "\n ------------------------";
+  std::string item;
+  bool got = q3.deQ(item, std::chrono::milliseconds(20));
+  std::cout << "\n  empty queue timed out: " << std::boolalpha << !got;
+  q3.enQ("timed");
+  got = q3.deQ(item, std::chrono::milliseconds(20));
+  std::cout << "\n  deQed " << item << ": " << got << "\n";
+  std::cout << "\n  Moving and emplacing elements";
+  std::cout << "\n -------------------------------";
+  std::string moved = "moved element";
+  q3.enQ(std::move(moved));
+  q3.emplace(3, '*');
+  std::cout << "\n  source after move is empty: " << moved.empty();
+  std::cout << "\n  deQed " << q3.deQ() << ", " << q3.deQ() << "\n";
+  std::cout << "\n  Lock-free MpscQueue, four producers, batched deQ";
+  std::cout << "\n --------------------------------------------------";
+  MpscQueue<std::string> mq(16);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < 4; ++p)
+  {
+    producers.push_back(std::thread([&mq, p]() {
+      for (int i = 0; i < 100; ++i)
+        mq.enQ(std::string("producer#") + std::to_string(p));
+    }));
+  }
+  std::vector<std::string> batch;
+  size_t received = 0, batches = 0;
+  while (received < 400)
+  {
+    batch.clear();
+    received += mq.deQ(batch, 32);
+    ++batches;
+  }
+  for (auto& thrd : producers)
+    thrd.join();
+  std::cout << "\n  capacity = " << mq.capacity();
+  std::cout << "\n  deQed " << received << " items in " << batches << " batches";
+  std::cout << "\n  mq.size() = " << mq.size();
+  got = mq.deQ(item, std::chrono::milliseconds(20));
+  std::cout << "\n  empty queue timed out: " << !got << "\n";
   std::cout << "\n\n";
 }
 
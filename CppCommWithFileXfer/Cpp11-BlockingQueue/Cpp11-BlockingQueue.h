@@ -2,7 +2,7 @@
 #define CPP11_BLOCKINGQUEUE_H
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.h - Thread-safe Blocking Queue        //
-// ver 1.3                                                   //
+// ver 1.5                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
 ///////////////////////////////////////////////////////////////
 /*
@@ -24,6 +24,12 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.5 : 17 Oct 2026
+ * - added enQ(T&&) and emplace(args...), and deQ moves elements
+ *   out, so queued messages are moved rather than copied
+ * ver 1.4 : 17 Oct 2026
+ * - added deQ(t, timeout), which gives up if the queue stays
+ *   empty for timeout
  * ver 1.3 : 04 Mar 2016
  * - changed behavior of front() to throw exception
  *   on empty queue.
@@ -40,12 +46,14 @@
  */
 
 #include <condition_variable>
+#include <chrono>
 #include <mutex>
 #include <thread>
 #include <queue>
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 template <typename T>
 class BlockingQueue {
@@ -56,7 +64,11 @@ public:
   BlockingQueue(const BlockingQueue<T>&) = delete;
   BlockingQueue<T>& operator=(const BlockingQueue<T>&) = delete;
   T deQ();
+  bool deQ(T& t, std::chrono::milliseconds timeout);
   void enQ(const T& t);
+  void enQ(T&& t);
+  template<typename... Args>
+  void emplace(Args&&... args);
   T& front();
   void clear();
   size_t size();
@@ -71,7 +83,7 @@ template<typename T>
 BlockingQueue<T>::BlockingQueue(BlockingQueue<T>&& bq) // need to lock so can't initialize
 {
   std::lock_guard<std::mutex> l(mtx_);
-  q_ = bq.q_;
+  q_ = std::move(bq.q_);
   while (bq.q_.size() > 0)  // clear bq
     bq.q_.pop();
   /* can't copy  or move mutex or condition variable, so use default members */
@@ -83,7 +95,7 @@ BlockingQueue<T>& BlockingQueue<T>::operator=(BlockingQueue<T>&& bq)
 {
   if (this == &bq) return *this;
   std::lock_guard<std::mutex> l(mtx_);
-  q_ = bq.q_;
+  q_ = std::move(bq.q_);
   while (bq.q_.size() > 0)  // clear bq
     bq.q_.pop();
   /* can't move assign mutex or condition variable so use target's */
@@ -107,7 +119,7 @@ T BlockingQueue<T>::deQ()
    */
   if(q_.size() > 0)
   {
-    T temp = q_.front();
+    T temp = std::move(q_.front());
     q_.pop();
     return temp;
   }
@@ -115,10 +127,24 @@ T BlockingQueue<T>::deQ()
 
   while (q_.size() == 0)
     cv_.wait(l, [this] () { return q_.size() > 0; });
-  T temp = q_.front();
+  T temp = std::move(q_.front());
   q_.pop();
   return temp;
 }
+//----< remove front element, waiting at most timeout >----------------
+/*
+ *  - returns false, leaving t unchanged, if the queue stayed empty
+ */
+template<typename T>
+bool BlockingQueue<T>::deQ(T& t, std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> l(mtx_);
+  if (!cv_.wait_for(l, timeout, [this] () { return q_.size() > 0; }))
+    return false;
+  t = std::move(q_.front());
+  q_.pop();
+  return true;
+}
 //----< push element onto back of queue >------------------------------
 
 template<typename T>
@@ -130,6 +156,29 @@ void BlockingQueue<T>::enQ(const T& t)
   }
   cv_.notify_one();
 }
+//----< move element onto back of queue >------------------------------
+
+template<typename T>
+void BlockingQueue<T>::enQ(T&& t)
+{
+  {
+    std::unique_lock<std::mutex> l(mtx_);
+    q_.push(std::move(t));
+  }
+  cv_.notify_one();
+}
+//----< construct element in place at back of queue >------------------
+
+template<typename T>
+template<typename... Args>
+void BlockingQueue<T>::emplace(Args&&... args)
+{
+  {
+    std::unique_lock<std::mutex> l(mtx_);
+    q_.emplace(std::forward<Args>(args)...);
+  }
+  cv_.notify_one();
+}
 //----< peek at next item to be popped >-------------------------------
 
 template <typename T>
@@ -0,0 +1,367 @@
+#ifndef CPP11_MPSCQUEUE_H
+#define CPP11_MPSCQUEUE_H
+/////////////////////////////////////////////////////////////////////
+// Cpp11-MpscQueue.h - bounded lock-free multi-producer queue      //
+//                                                                 //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                     //
+// Reference: Jim Fawcett                                          //
+// Application: RepositoryApp                                      //
+// Environment: C++ console                                        //
+// Platform: Lenovo T460                                           //
+// Operating System: Windows 10                                    //
+/////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package contains one thread-safe class: MpscQueue<T>.  It has
+*  the BlockingQueue<T> interface, so it can replace a BlockingQueue
+*  that many threads enQ and a single thread deQs.
+*  - items are held in a fixed ring of capacity slots, rounded up to a
+*    power of two.  Producers claim a slot with a compare-exchange and
+*    the consumer takes slots in order, so neither takes a lock while
+*    the queue is neither empty nor full.
+*  - enQ(T&&) and deQ() move items in and out.  enQ(const T&) copies.
+*    emplace(args...) builds the item, then moves it into its slot.
+*  - deQ(items, maxItems) moves out up to maxItems waiting items at
+*    once, so a busy consumer pays for one wait per batch.
+*  - a thread that must wait, the consumer on an empty queue or a
+*    producer on a full one, first spins, then yields, and only then
+*    parks on a condition variable.  Producers and the consumer only
+*    lock the mutex to wake a thread that has parked.
+*  - tryEnQ and tryDeQ never wait.
+*
+*  Only one thread may call deQ, tryDeQ, front, and clear.
+*
+*  Required Files:
+*  ---------------
+*  Cpp11-MpscQueue.h
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added emplace
+*  ver 1.0 : 17th October 2026
+*  - first release
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <new>
+#include <utility>
+#include <exception>
+
+template <typename T>
+class MpscQueue {
+public:
+  static const size_t DefaultCapacity = 4096;
+  static const size_t SpinCount = 64;
+  static const size_t YieldCount = 16;
+
+  explicit MpscQueue(size_t capacity = DefaultCapacity);
+  ~MpscQueue();
+  MpscQueue(const MpscQueue<T>&) = delete;
+  MpscQueue<T>& operator=(const MpscQueue<T>&) = delete;
+  T deQ();
+  bool deQ(T& t, std::chrono::milliseconds timeout);
+  size_t deQ(std::vector<T>& items, size_t maxItems);
+  bool tryDeQ(T& t);
+  void enQ(const T& t);
+  void enQ(T&& t);
+  bool tryEnQ(T&& t);
+  template<typename... Args>
+  void emplace(Args&&... args);
+  T& front();
+  void clear();
+  size_t size();
+  size_t capacity() { return mask_ + 1; }
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+    T* item() { return reinterpret_cast<T*>(storage); }
+  };
+  bool readable();
+  bool writable();
+  template<typename Ready>
+  bool spin(Ready ready);
+  template<typename Ready>
+  void park(Ready ready, std::condition_variable& cv, std::atomic<size_t>& parked);
+  template<typename Ready>
+  bool park(Ready ready, std::condition_variable& cv, std::atomic<size_t>& parked, std::chrono::steady_clock::time_point deadline);
+  void wake(std::condition_variable& cv, std::atomic<size_t>& parked, bool all);
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> enqueuePos_;
+  alignas(64) std::atomic<size_t> dequeuePos_;
+  alignas(64) std::atomic<size_t> consumerParked_;
+  std::atomic<size_t> producersParked_;
+  std::mutex mtx_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+};
+//----< allocate ring of at least capacity slots >---------------------
+
+template<typename T>
+MpscQueue<T>::MpscQueue(size_t capacity)
+  : enqueuePos_(0), dequeuePos_(0), consumerParked_(0), producersParked_(0)
+{
+  size_t slots = 2;
+  while (slots < capacity)
+    slots <<= 1;
+  cells_.reset(new Cell[slots]);
+  for (size_t i = 0; i < slots; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  mask_ = slots - 1;
+}
+//----< destroy items still in the queue >-----------------------------
+
+template<typename T>
+MpscQueue<T>::~MpscQueue()
+{
+  clear();
+}
+//----< remove element from front of queue, waiting if empty >---------
+
+template<typename T>
+T MpscQueue<T>::deQ()
+{
+  T t;
+  while (!tryDeQ(t))
+    park([this]() { return readable(); }, notEmpty_, consumerParked_);
+  return t;
+}
+//----< remove front element, waiting at most timeout >----------------
+/*
+ *  - returns false, leaving t unchanged, if the queue stayed empty
+ */
+template<typename T>
+bool MpscQueue<T>::deQ(T& t, std::chrono::milliseconds timeout)
+{
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+  while (!tryDeQ(t))
+  {
+    if (!park([this]() { return readable(); }, notEmpty_, consumerParked_, deadline))
+      return false;
+  }
+  return true;
+}
+//----< move up to maxItems elements onto back of items >--------------
+/*
+ *  - waits until at least one element is queued, then takes only
+ *    elements already queued
+ *  - returns number of elements added to items
+ */
+template<typename T>
+size_t MpscQueue<T>::deQ(std::vector<T>& items, size_t maxItems)
+{
+  if (maxItems == 0)
+    return 0;
+  if (!readable())
+    park([this]() { return readable(); }, notEmpty_, consumerParked_);
+  size_t count = 0;
+  size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+  while (count < maxItems)
+  {
+    Cell& cell = cells_[pos & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+      break;
+    items.push_back(std::move(*cell.item()));
+    cell.item()->~T();
+    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    ++pos;
+    ++count;
+  }
+  dequeuePos_.store(pos, std::memory_order_release);
+  wake(notFull_, producersParked_, true);
+  return count;
+}
+//----< remove front element if there is one, never waits >------------
+
+template<typename T>
+bool MpscQueue<T>::tryDeQ(T& t)
+{
+  size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+  Cell& cell = cells_[pos & mask_];
+  if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+    return false;
+  t = std::move(*cell.item());
+  cell.item()->~T();
+  cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+  dequeuePos_.store(pos + 1, std::memory_order_release);
+  wake(notFull_, producersParked_, false);
+  return true;
+}
+//----< push copy of element onto back of queue >----------------------
+
+template<typename T>
+void MpscQueue<T>::enQ(const T& t)
+{
+  T temp(t);
+  enQ(std::move(temp));
+}
+//----< move element onto back of queue, waiting if full >-------------
+
+template<typename T>
+void MpscQueue<T>::enQ(T&& t)
+{
+  while (!tryEnQ(std::move(t)))
+    park([this]() { return writable(); }, notFull_, producersParked_);
+}
+//----< construct element from args and move it onto back of queue >---
+/*
+ *  - the element is built before a slot is claimed, so a constructor
+ *    that throws can't leave a claimed slot that is never published
+ */
+template<typename T>
+template<typename... Args>
+void MpscQueue<T>::emplace(Args&&... args)
+{
+  enQ(T(std::forward<Args>(args)...));
+}
+//----< move element onto back of queue unless full >------------------
+/*
+ *  - t is left unchanged if the queue is full
+ */
+template<typename T>
+bool MpscQueue<T>::tryEnQ(T&& t)
+{
+  size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+  Cell* pCell = nullptr;
+  while (true)
+  {
+    pCell = &cells_[pos & mask_];
+    size_t seq = pCell->sequence.load(std::memory_order_acquire);
+    if (seq == pos)
+    {
+      if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (seq < pos)
+      return false;
+    else
+      pos = enqueuePos_.load(std::memory_order_relaxed);
+  }
+  new (pCell->storage) T(std::move(t));
+  pCell->sequence.store(pos + 1, std::memory_order_release);
+  wake(notEmpty_, consumerParked_, false);
+  return true;
+}
+//----< peek at next item to be popped >-------------------------------
+
+template<typename T>
+T& MpscQueue<T>::front()
+{
+  if (readable())
+    return *cells_[dequeuePos_.load(std::memory_order_relaxed) & mask_].item();
+  throw std::exception("attempt to deQue empty queue");
+}
+//----< remove all elements from queue >-------------------------------
+
+template<typename T>
+void MpscQueue<T>::clear()
+{
+  std::vector<T> items;
+  while (readable())
+  {
+    items.clear();
+    deQ(items, capacity());
+  }
+}
+//----< return number of elements in queue >---------------------------
+/*
+ *  - includes elements a producer is still writing
+ */
+template<typename T>
+size_t MpscQueue<T>::size()
+{
+  size_t dequeued = dequeuePos_.load(std::memory_order_acquire);
+  return enqueuePos_.load(std::memory_order_acquire) - dequeued;
+}
+//----< is front element ready to deQ? >-------------------------------
+
+template<typename T>
+bool MpscQueue<T>::readable()
+{
+  size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+  return cells_[pos & mask_].sequence.load(std::memory_order_acquire) == pos + 1;
+}
+//----< is there a free slot to enQ into? >----------------------------
+
+template<typename T>
+bool MpscQueue<T>::writable()
+{
+  size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+  return cells_[pos & mask_].sequence.load(std::memory_order_acquire) >= pos;
+}
+//----< busy wait a short while for ready() >--------------------------
+
+template<typename T>
+template<typename Ready>
+bool MpscQueue<T>::spin(Ready ready)
+{
+  for (size_t i = 0; i < SpinCount + YieldCount; ++i)
+  {
+    if (ready())
+      return true;
+    if (i >= SpinCount)
+      std::this_thread::yield();
+  }
+  return false;
+}
+//----< spin, then sleep on cv until ready() >-------------------------
+/*
+ *  - parked is raised before ready() is checked under the lock, and
+ *    wake() checks parked after publishing, so a wakeup can't be lost
+ */
+template<typename T>
+template<typename Ready>
+void MpscQueue<T>::park(Ready ready, std::condition_variable& cv, std::atomic<size_t>& parked)
+{
+  if (spin(ready))
+    return;
+  std::unique_lock<std::mutex> l(mtx_);
+  parked.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  cv.wait(l, ready);
+  parked.fetch_sub(1);
+}
+//----< spin, then sleep on cv until ready() or deadline >-------------
+
+template<typename T>
+template<typename Ready>
+bool MpscQueue<T>::park(Ready ready, std::condition_variable& cv, std::atomic<size_t>& parked, std::chrono::steady_clock::time_point deadline)
+{
+  if (spin(ready))
+    return true;
+  std::unique_lock<std::mutex> l(mtx_);
+  parked.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool isReady = cv.wait_until(l, deadline, ready);
+  parked.fetch_sub(1);
+  return isReady;
+}
+//----< wake threads parked on cv, if there are any >------------------
+
+template<typename T>
+void MpscQueue<T>::wake(std::condition_variable& cv, std::atomic<size_t>& parked, bool all)
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (parked.load(std::memory_order_relaxed) == 0)
+    return;
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+  }
+  if (all)
+    cv.notify_all();
+  else
+    cv.notify_one();
+}
+
+#endif
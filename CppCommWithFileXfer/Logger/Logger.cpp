@@ -12,9 +12,27 @@
 * Package Operations:
 * -------------------
 * This package supports logging for multiple concurrent clients to a
-* single std::ostream.  It does this be enqueuing messages in a
-* blocking queue and dequeuing with a single thread that writes to
-* the std::ostream.
+* single std::ostream.  Each thread that logs gets its own preallocated
+* ring of LogRecords, and a single Logger thread drains every ring, in
+* batches, to the std::ostream.
+* - a LogRecord is binary: text arguments are copied into the record's
+*   fixed buffer and numbers are stored as numbers.  Records are only
+*   formatted into text by the Logger thread, so write neither formats
+*   nor allocates on the caller's thread.
+* - each record has a Level.  Records below the runtime level(), or
+*   below LOGGER_MIN_LEVEL, defined at compile time, are not logged.
+* - the LOG_WRITE macro checks enabled() before evaluating any of its
+*   arguments, so a disabled log statement costs one comparison.
+* - a full ring drops records, rather than making the caller wait, and
+*   the Logger thread reports how many were dropped.
+* - records from one thread are written in the order they were logged.
+* - write(level, text) splits long text, like a database dump, across
+*   as many records as it needs.  When the ring fills, it waits for the
+*   Logger thread to make room, so long text is never cut off.
+*
+* StaticLogger<1> carries Comm's trace messages and Diagnostics, which
+* is StaticLogger<2>, carries the servers' diagnostic output.  Neither
+* logs anything until it is started.
 *
 * Build Process:
 * --------------
@@ -24,29 +42,95 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 17th October 2026
+* - per-thread rings of binary LogRecords replace the shared queue of
+*   strings, records are formatted by the Logger thread
+* - added log levels, LOGGER_MIN_LEVEL, and the LOG_WRITE macro
+* - added write(level, text) for long text, and the Diagnostics channel
+* - write(level, text) waits for room in a full ring instead of dropping
+* - flush waits on a condition variable, not a polling sleep
+* ver 1.1 : 17th October 2026
+* - messages are queued in a lock-free MpscQueue and written in batches
 * ver 1: 6th April 2018
 */
 
 #include <functional>
-#include <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
 #include "Logger.h"
 #include "../Utilities/Utilities.h"
 
-//----< send text message to std::ostream >--------------------------
+//----< append record's arguments to out as text >-------------------
+
+void LogRecord::format(std::string& out)
+{
+  char digits[24];
+  for (size_t i = 0; i < numArgs; ++i)
+  {
+    Arg& arg = args[i];
+    if (arg.kind == text)
+      out.append(buffer + arg.offset, arg.length);
+    else if (arg.kind == signedNumber)
+      out.append(digits, std::snprintf(digits, sizeof(digits), "%lld", arg.number));
+    else
+      out.append(digits, std::snprintf(digits, sizeof(digits), "%llu", arg.unsignedNum));
+  }
+}
+//----< allocate ring of at least capacity records >-----------------
 
-void Logger::write(const std::string& msg)
+LogRing::LogRing(size_t capacity) : head_(0), tail_(0), dropped_(0)
 {
-  if(_ThreadRunning)
-    _queue.enQ(msg);
+  size_t slots = 2;
+  while (slots < capacity)
+    slots <<= 1;
+  records_.reset(new LogRecord[slots]);
+  mask_ = slots - 1;
 }
-//----< flush ostream buffer >---------------------------------------
+//----< give each Logger an id, used to find this thread's ring >------
+
+Logger::Logger() : _id(nextId()), _level(trace), _ThreadRunning(false), _stopping(false), _idle(false), _waiters(0) {}
+
+//----< send text message to std::ostream >--------------------------
+/*
+*  - text longer than a record is split across records
+*  - waits for the Logger thread to drain a full ring, so only a stop
+*    while waiting drops the rest of the text
+*/
+void Logger::write(Level level, const std::string& msg)
+{
+  if (!enabled(level))
+    return;
+  LogRing* pRing = ring();
+  size_t pos = 0;
+  do
+  {
+    LogRecord* pRecord = pRing->claim();
+    if (pRecord == nullptr)
+      waitDrained([&]() { return (pRecord = pRing->claim()) != nullptr; });
+    if (pRecord == nullptr)
+    {
+      pRing->drop();
+      break;
+    }
+    size_t length = msg.size() - pos;
+    if (length > LogRecord::TextSize)
+      length = LogRecord::TextSize;
+    pRecord->clear();
+    pRecord->level = level;
+    pRecord->add(msg.data() + pos, length);
+    pRing->publish();
+    pos += length;
+  } while (pos < msg.size());
+  wake();
+}
+//----< wait for records logged so far to be written, then flush >---
 
 void Logger::flush()
 {
   if (_ThreadRunning)
   {
-    while (_queue.size() > 0)  // wait for logger queue to empty
-      ::Sleep(50);
+    waitDrained([this]() { return !pending(); });
     _pOut->flush();
   }
 }
@@ -62,39 +146,54 @@ void Logger::attach(std::ostream* pOut)
   _pOut = pOut; 
 }
 //----< start logging >----------------------------------------------
-
+/*
+*  - the Logger thread sleeps only when every ring is empty
+*/
 void Logger::start()
 {
   if (_ThreadRunning)
     return;
+  _stopping = false;
   _ThreadRunning = true;
   std::function<void()> tp = [=]() {
+    _text.reserve(BatchSize * LogRecord::TextSize);
     while (true)
     {
-      std::string msg = _queue.deQ();
-      if (msg == "quit")
+      if (drain())
       {
-        _ThreadRunning = false;
-        break;
+        notifyDrained();
+        continue;
       }
-      *_pOut << msg;
+      if (_stopping)
+        return;
+      std::unique_lock<std::mutex> lock(_mtx);
+      _idle = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      _cv.wait_for(lock, std::chrono::milliseconds(100), [this]() { return _stopping || pending(); });
+      _idle = false;
     }
   };
-  std::thread thr(tp);
-  thr.detach();
+  _thread = std::thread(tp);
 }
 //----< stop logging >-----------------------------------------------
-
+/*
+*  - records logged before stop are written before it returns
+*/
 void Logger::stop(const std::string& msg)
 {
   if (_ThreadRunning)
   {
     if(msg != "")
       write(msg);
-    write("quit");  // request thread to stop
-    while (_ThreadRunning)
-      /* wait for thread to stop*/
-      ;
+    _ThreadRunning = false;
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      _stopping = true;
+    }
+    _cv.notify_one();
+    _drained.notify_all();
+    if (_thread.joinable())
+      _thread.join();
   }
 }
 //----< stop logging thread >----------------------------------------
@@ -103,6 +202,118 @@ Logger::~Logger()
 {
   stop(); 
 }
+//----< unique id for each Logger >----------------------------------
+
+size_t Logger::nextId()
+{
+  static std::atomic<size_t> id(0);
+  return ++id;
+}
+//----< this thread's ring, created on its first write >-------------
+/*
+*  - a thread's rings are shared with their Loggers, so records left
+*    when a thread ends are still drained
+*/
+LogRing* Logger::ring()
+{
+  thread_local std::vector<std::pair<size_t, std::shared_ptr<LogRing>>> rings;
+  for (auto& item : rings)
+  {
+    if (item.first == _id)
+      return item.second.get();
+  }
+  std::shared_ptr<LogRing> pRing(new LogRing(RingSize));
+  {
+    std::lock_guard<std::mutex> lock(_ringsMtx);
+    _rings.push_back(pRing);
+  }
+  rings.push_back(std::make_pair(_id, pRing));
+  return pRing.get();
+}
+//----< wake Logger thread if it's waiting for records >-------------
+
+void Logger::wake()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!_idle.load(std::memory_order_relaxed))
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+  }
+  _cv.notify_one();
+}
+//----< block until done() or Logger stops, waking Logger to drain >--
+/*
+*  - done is checked holding _mtx, which notifyDrained takes before
+*    notifying, so a drain can't slip between the check and the wait
+*/
+template<typename Pred>
+void Logger::waitDrained(Pred done)
+{
+  _waiters.fetch_add(1);
+  wake();
+  {
+    std::unique_lock<std::mutex> lock(_mtx);
+    _drained.wait(lock, [&]() { return _stopping || done(); });
+  }
+  _waiters.fetch_sub(1);
+}
+//----< wake threads waiting for records to be drained >-------------
+
+void Logger::notifyDrained()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (_waiters.load(std::memory_order_relaxed) == 0)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+  }
+  _drained.notify_all();
+}
+//----< write up to BatchSize records from each ring >---------------
+/*
+*  - returns false if there were no records to write
+*  - rings of threads that have ended are removed once empty
+*/
+bool Logger::drain()
+{
+  std::lock_guard<std::mutex> lock(_ringsMtx);
+  _text.clear();
+  bool drained = false;
+  for (size_t i = 0; i < _rings.size(); ++i)
+  {
+    LogRing& ring = *_rings[i];
+    size_t count = 0;
+    LogRecord* pRecord = nullptr;
+    while (count < BatchSize && (pRecord = ring.front()) != nullptr)
+    {
+      pRecord->format(_text);
+      ring.pop();
+      ++count;
+    }
+    size_t dropped = ring.takeDropped();
+    if (dropped > 0)
+      _text += "\n  -- logger dropped " + std::to_string(dropped) + " records";
+    drained = drained || count > 0;
+    if (ring.empty() && _rings[i].use_count() == 1)
+      _rings.erase(_rings.begin() + i--);
+  }
+  if (_text.size() > 0)
+    _pOut->write(_text.data(), _text.size());
+  return drained;
+}
+//----< are records waiting to be written? >-------------------------
+
+bool Logger::pending()
+{
+  std::lock_guard<std::mutex> lock(_ringsMtx);
+  for (auto& pRing : _rings)
+  {
+    if (!pRing->empty())
+      return true;
+  }
+  return false;
+}
 
 #ifdef TEST_LOGGER
 
@@ -135,6 +346,41 @@ int main()
   StaticLogger<1>::write("\n  static logger at work");
   Logger& logger = StaticLogger<1>::instance();
   logger.write("\n  static logger still at work");
+
+  StaticLogger<1>::title("Testing levels and binary records");
+  StaticLogger<1>::level(Logger::info);
+  size_t evaluated = 0;
+  auto count = [&evaluated]() { return ++evaluated; };
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  won't get logged - below level ", count());
+  LOG_WRITE(StaticLogger<1>, Logger::warning, "\n  warning record #", count(), ", ", std::string("text copied"));
+  StaticLogger<1>::flush();
+  std::cout << "\n  arguments evaluated for " << evaluated << " of 2 log statements";
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.push_back(std::thread([t]() {
+      for (int j = 0; j < 3; ++j)
+        StaticLogger<1>::write(Logger::info, "\n  thread ", t, " record ", j);
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  StaticLogger<1>::title("Testing long text");
+  std::ostringstream dump;
+  Logger dumpLog;
+  dumpLog.attach(&dump);
+  dumpLog.start();
+  std::string text(Logger::RingSize * LogRecord::TextSize * 4, 'x');
+  dumpLog.write(Logger::info, text);
+  dumpLog.flush();
+  StaticLogger<1>::write(Logger::info, "\n  flushed ", dump.str().size(), " of ", text.size(), " characters");
+  dumpLog.stop();
+  if (dump.str() == text)
+    StaticLogger<1>::write("\n  long text test passed");
+  else
+    StaticLogger<1>::write("\n  long text test failed");
   logger.stop("\n  stopping static logger");
 }
 
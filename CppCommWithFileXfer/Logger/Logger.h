@@ -6,17 +6,35 @@
 // Author: Naga Rama Krishna, nrchalam@syr.edu                         //
 // Reference: Jim Fawcett                                              //
 // Application: RepositoryApp                                          //
-// Environment: C++ console                                            // 
-// Platform: Lenovo T460                                               // 
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
 // Operating System: Windows 10                                        //
 /////////////////////////////////////////////////////////////////////////
 /*
 * Package Operations:
 * -------------------
 * This package supports logging for multiple concurrent clients to a
-* single std::ostream.  It does this be enqueuing messages in a
-* blocking queue and dequeuing with a single thread that writes to
-* the std::ostream.
+* single std::ostream.  Each thread that logs gets its own preallocated
+* ring of LogRecords, and a single Logger thread drains every ring, in
+* batches, to the std::ostream.
+* - a LogRecord is binary: text arguments are copied into the record's
+*   fixed buffer and numbers are stored as numbers.  Records are only
+*   formatted into text by the Logger thread, so write neither formats
+*   nor allocates on the caller's thread.
+* - each record has a Level.  Records below the runtime level(), or
+*   below LOGGER_MIN_LEVEL, defined at compile time, are not logged.
+* - the LOG_WRITE macro checks enabled() before evaluating any of its
+*   arguments, so a disabled log statement costs one comparison.
+* - a full ring drops records, rather than making the caller wait, and
+*   the Logger thread reports how many were dropped.
+* - records from one thread are written in the order they were logged.
+* - write(level, text) splits long text, like a database dump, across
+*   as many records as it needs.  When the ring fills, it waits for the
+*   Logger thread to make room, so long text is never cut off.
+*
+* StaticLogger<1> carries Comm's trace messages and Diagnostics, which
+* is StaticLogger<2>, carries the servers' diagnostic output.  Neither
+* logs anything until it is started.
 *
 * Build Process:
 * --------------
@@ -26,33 +44,242 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 17th October 2026
+* - per-thread rings of binary LogRecords replace the shared queue of
+*   strings, records are formatted by the Logger thread
+* - added log levels, LOGGER_MIN_LEVEL, and the LOG_WRITE macro
+* - added write(level, text) for long text, and the Diagnostics channel
+* - write(level, text) waits for room in a full ring instead of dropping
+* - flush waits on a condition variable, not a polling sleep
+* ver 1.1 : 17th October 2026
+* - messages are queued in a lock-free MpscQueue and written in batches
 * ver 1: 6th April 2018
 */
 
 #include <iostream>
 #include <string>
 #include <thread>
-#include "Cpp11-BlockingQueue.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <cstring>
+
+/////////////////////////////////////////////////////////////////////
+// lowest level compiled in, 0 logs everything, 2 drops trace and debug
+
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 0
+#endif
+
+/////////////////////////////////////////////////////////////////////
+// LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- sent ", msg.name())
+// - arguments are only evaluated if the level is enabled
+
+#define LOG_WRITE(Log, level, ...) \
+  do { if (Log::enabled(level)) Log::write(level, __VA_ARGS__); } while (false)
+
+/////////////////////////////////////////////////////////////////////
+// LogRecord struct
+// - one log statement: level and up to MaxArgs text or number arguments
+// - text longer than the record's buffer is truncated
+
+struct LogRecord
+{
+  static const size_t MaxArgs = 8;
+  static const size_t TextSize = 240;
+  enum Kind { text, signedNumber, unsignedNumber };
+
+  struct Arg
+  {
+    Kind kind;
+    union
+    {
+      size_t offset;
+      long long number;
+      unsigned long long unsignedNum;
+    };
+    size_t length;
+  };
+
+  void clear() { numArgs = 0; textUsed = 0; }
+  void add(const char* pText, size_t length);
+  void add(const char* pText) { add(pText, std::strlen(pText)); }
+  void add(const std::string& str) { add(str.data(), str.size()); }
+  void add(char ch) { add(&ch, 1); }
+  template<typename T>
+  void add(T number);
+  void format(std::string& out);
+
+  int level;
+  size_t numArgs;
+  size_t textUsed;
+  Arg args[MaxArgs];
+  char buffer[TextSize];
+};
+//----< copy text argument into record's buffer >---------------------
+
+inline void LogRecord::add(const char* pText, size_t length)
+{
+  if (numArgs == MaxArgs)
+    return;
+  if (length > TextSize - textUsed)
+    length = TextSize - textUsed;
+  Arg& arg = args[numArgs++];
+  arg.kind = text;
+  arg.offset = textUsed;
+  arg.length = length;
+  std::memcpy(buffer + textUsed, pText, length);
+  textUsed += length;
+}
+//----< store integral argument, formatted when drained >-------------
+
+template<typename T>
+void LogRecord::add(T number)
+{
+  static_assert(std::is_integral<T>::value, "log arguments are text or integers");
+  if (numArgs == MaxArgs)
+    return;
+  Arg& arg = args[numArgs++];
+  if (std::is_signed<T>::value)
+  {
+    arg.kind = signedNumber;
+    arg.number = static_cast<long long>(number);
+  }
+  else
+  {
+    arg.kind = unsignedNumber;
+    arg.unsignedNum = static_cast<unsigned long long>(number);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+// LogRing class
+// - single-producer single-consumer ring of preallocated LogRecords
+// - the producer is the thread that owns the ring, the consumer is
+//   the Logger thread
+
+class LogRing
+{
+public:
+  explicit LogRing(size_t capacity);
+  LogRing(const LogRing&) = delete;
+  LogRing& operator=(const LogRing&) = delete;
+
+  LogRecord* claim();
+  void publish() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+  void drop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+  LogRecord* front();
+  void pop() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+  bool empty() { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+  size_t takeDropped() { return dropped_.exchange(0); }
+private:
+  std::unique_ptr<LogRecord[]> records_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+  std::atomic<size_t> dropped_;
+};
+//----< return next free record, or nullptr if ring is full >---------
+
+inline LogRecord* LogRing::claim()
+{
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) > mask_)
+    return nullptr;
+  return &records_[tail & mask_];
+}
+//----< return oldest published record, or nullptr if none >---------
+
+inline LogRecord* LogRing::front()
+{
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire))
+    return nullptr;
+  return &records_[head & mask_];
+}
 
 class Logger
 {
 public:
-  Logger() {}
+  enum Level { trace, debug, info, warning, error, off };
+
+  Logger();
   void attach(std::ostream* pOut);
   void start();
   void stop(const std::string& msg = "");
-  void write(const std::string& msg);
+  bool enabled(Level level);
+  void level(Level level) { _level = level; }
+  Level level() { return static_cast<Level>(_level.load()); }
+  template<typename... Args>
+  void write(Level level, const Args&... args);
+  void write(Level level, const std::string& text);
+  void write(const std::string& msg) { write(info, msg); }
   void flush();
   void title(const std::string& msg, char underline = '-');
+  static const size_t BatchSize = 64;
+  static const size_t RingSize = 256;
   ~Logger();
   Logger(const Logger&) = delete;
   Logger& operator=(const Logger&) = delete;
 private:
-  std::thread* _pThr;
-  std::ostream* _pOut;
-  BlockingQueue<std::string> _queue;
-  bool _ThreadRunning = false;
+  static size_t nextId();
+  LogRing* ring();
+  void wake();
+  bool drain();
+  bool pending();
+  template<typename Pred>
+  void waitDrained(Pred done);
+  void notifyDrained();
+
+  std::thread _thread;
+  std::ostream* _pOut = &std::cout;
+  const size_t _id;
+  std::atomic<int> _level;
+  std::atomic<bool> _ThreadRunning;
+  std::atomic<bool> _stopping;
+  std::atomic<bool> _idle;
+  std::atomic<size_t> _waiters;
+  std::mutex _ringsMtx;
+  std::vector<std::shared_ptr<LogRing>> _rings;
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::condition_variable _drained;
+  std::string _text;
 };
+//----< will a record at level be logged? >----------------------------
+
+inline bool Logger::enabled(Level level)
+{
+  return level >= LOGGER_MIN_LEVEL && level >= _level.load(std::memory_order_relaxed)
+    && _ThreadRunning.load(std::memory_order_relaxed);
+}
+//----< copy args into a record on this thread's ring >----------------
+/*
+*  - never allocates, except for the ring on a thread's first write
+*/
+template<typename... Args>
+void Logger::write(Level level, const Args&... args)
+{
+  static_assert(sizeof...(Args) <= LogRecord::MaxArgs, "too many log arguments");
+  if (!enabled(level))
+    return;
+  LogRing* pRing = ring();
+  LogRecord* pRecord = pRing->claim();
+  if (pRecord == nullptr)
+  {
+    pRing->drop();
+    return;
+  }
+  pRecord->clear();
+  pRecord->level = level;
+  int expand[] = { 0, (pRecord->add(args), 0)... };
+  (void)expand;
+  pRing->publish();
+  wake();
+}
 
 template<int i>
 class StaticLogger
@@ -61,6 +288,11 @@ public:
   static void attach(std::ostream* pOut) { _logger.attach(pOut); }
   static void start() { _logger.start(); }
   static void stop(const std::string& msg="") { _logger.stop(msg); }
+  static bool enabled(Logger::Level level) { return _logger.enabled(level); }
+  static void level(Logger::Level level) { _logger.level(level); }
+  template<typename... Args>
+  static void write(Logger::Level level, const Args&... args) { _logger.write(level, args...); }
+  static void write(Logger::Level level, const std::string& text) { _logger.write(level, text); }
   static void write(const std::string& msg) { _logger.write(msg); }
   static void flush() { _logger.flush(); }
   static void title(const std::string& msg, char underline = '-') { _logger.title(msg, underline); }
@@ -74,6 +306,8 @@ private:
 template<int i>
 Logger StaticLogger<i>::_logger;
 
+using Diagnostics = StaticLogger<2>;
+
 struct Cosmetic
 {
   ~Cosmetic() { std::cout << "\n\n"; }
@@ -17,6 +17,7 @@
 *    name:value pairs.
 *  - Message have a number of getter, setter methods for common attributes, and allow
 *    definition of other "custom" attributes.
+*  - Messages can also be encoded in a compact, length-prefixed binary form.
 *
 *  Required Files:
 *  ---------------
@@ -24,6 +25,8 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added binary encoding, toBinary and fromBinary
 *  ver 1: 6th April 2018
 *
 */
@@ -34,6 +37,16 @@
 using namespace MsgPassingCommunication;
 using SUtils = Utilities::StringHelper;
 
+//----< keys sent as one byte tags in binary messages >----------------
+/*
+*  - tag 0 means the key follows as a string
+*  - new keys must be added at the end, to keep old tags valid
+*/
+static const char* internedKeys[] = {
+  "", "to", "from", "command", "file", "content-length", "name", "clientPath", "transfer"
+};
+static const size_t numInternedKeys = sizeof(internedKeys) / sizeof(internedKeys[0]);
+
 //----< default constructor results in Message with no attributes >----
 
 Message::Message() {}
@@ -244,6 +257,145 @@ Message Message::fromString(const std::string& src)
   }
   return msg;
 }
+//----< tag for key, or 0 if key isn't interned >---------------------
+
+size_t Message::keyTag(const Key& key)
+{
+  for (size_t tag = 1; tag < numInternedKeys; ++tag)
+  {
+    if (key == internedKeys[tag])
+      return tag;
+  }
+  return 0;
+}
+//----< number of bytes in value's varint encoding >-------------------
+
+size_t Message::varintSize(size_t value)
+{
+  size_t size = 1;
+  while (value >= 0x80)
+  {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+//----< append value, seven bits per byte, low bits first >------------
+
+void Message::appendVarint(std::string& dest, size_t value)
+{
+  while (value >= 0x80)
+  {
+    dest.push_back((char)((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  dest.push_back((char)value);
+}
+//----< add one byte of a varint to value >----------------------------
+/*
+*  - returns true if byte is the varint's last byte
+*  - values too large for size_t saturate, so length checks fail
+*/
+bool Message::varintByte(char byte, size_t& value, size_t& shift)
+{
+  size_t bits = (unsigned char)byte & 0x7f;
+  if (shift >= 8 * sizeof(size_t) || (bits << shift) >> shift != bits)
+    value = (size_t)-1;
+  else
+    value |= bits << shift;
+  shift += 7;
+  return ((unsigned char)byte & 0x80) == 0;
+}
+//----< read varint at pData, advancing pData past it >----------------
+
+bool Message::readVarint(const char*& pData, const char* pEnd, size_t& value)
+{
+  value = 0;
+  size_t shift = 0;
+  while (pData < pEnd)
+  {
+    if (varintByte(*pData++, value, shift))
+      return true;
+  }
+  return false;
+}
+//----< convert message to binary frame >------------------------------
+/*
+*  - frame is BinaryMarker, varint body length, then the body:
+*    varint attribute count, then for each attribute a key tag, the
+*    key as varint length and bytes if its tag is 0, and the value as
+*    varint length and bytes
+*  - sizes the frame first, so it is built with one allocation
+*/
+std::string Message::toBinary()
+{
+  size_t bodySize = varintSize(attributes_.size());
+  for (auto& kv : attributes_)
+  {
+    bodySize += 1 + varintSize(kv.second.size()) + kv.second.size();
+    if (keyTag(kv.first) == 0)
+      bodySize += varintSize(kv.first.size()) + kv.first.size();
+  }
+  std::string frame;
+  frame.reserve(1 + varintSize(bodySize) + bodySize);
+  frame.push_back(BinaryMarker);
+  appendVarint(frame, bodySize);
+  appendVarint(frame, attributes_.size());
+  for (auto& kv : attributes_)
+  {
+    size_t tag = keyTag(kv.first);
+    frame.push_back((char)tag);
+    if (tag == 0)
+    {
+      appendVarint(frame, kv.first.size());
+      frame += kv.first;
+    }
+    appendVarint(frame, kv.second.size());
+    frame += kv.second;
+  }
+  return frame;
+}
+//----< decode binary frame body into msg >----------------------------
+/*
+*  - pBody points to bytes body bytes, read after the frame's marker
+*    and length
+*  - attributes are built in place from the body, with one allocation
+*    for the attribute table and none for interned keys
+*  - returns false if the body is malformed
+*/
+bool Message::fromBinary(const char* pBody, size_t bytes, Message& msg)
+{
+  const char* pEnd = pBody + bytes;
+  size_t count = 0;
+  if (!readVarint(pBody, pEnd, count) || count > bytes)
+    return false;
+  msg.attributes_.clear();
+  msg.attributes_.reserve(count);
+  Key key;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (pBody == pEnd)
+      return false;
+    size_t tag = (unsigned char)*pBody++;
+    size_t length = 0;
+    if (tag >= numInternedKeys)
+      return false;
+    if (tag > 0)
+      key = internedKeys[tag];
+    else
+    {
+      if (!readVarint(pBody, pEnd, length) || length > (size_t)(pEnd - pBody))
+        return false;
+      key.assign(pBody, length);
+      pBody += length;
+    }
+    if (!readVarint(pBody, pEnd, length) || length > (size_t)(pEnd - pBody))
+      return false;
+    msg.attributes_[key].assign(pBody, length);
+    pBody += length;
+  }
+  return pBody == pEnd;
+}
 //----< displays message on std::ostream >-----------------------------
 /*
 *  - adds beginning newline and removes trailing newline
@@ -300,6 +452,18 @@ int main()
 	std::cout << "\n  msg file          : " << newMsg.file();
 	std::cout << "\n  msg content-Length: " << newMsg.contentLength();
 	Utilities::putline();
+	SUtils::title("testing binary encoding, with a multi-line custom value");
+	msg.attribute("notes", "first line\nsecond line");
+	std::string frame = msg.toBinary();
+	std::cout << "\n  text size: " << msg.toString().size() << ", binary size: " << frame.size();
+	Message binMsg;
+	size_t bodySize = 0, shift = 0, pos = 1;
+	while (!Message::varintByte(frame[pos++], bodySize, shift));
+	bool decoded = Message::fromBinary(&frame[pos], bodySize, binMsg);
+	std::cout << "\n  decoded: " << std::boolalpha << decoded;
+	std::cout << "\n  same attributes: " << (binMsg.attributes() == msg.attributes());
+	std::cout << "\n  truncated body rejected: " << !Message::fromBinary(&frame[pos], bodySize - 1, binMsg);
+	Utilities::putline();
 	SUtils::title("adding custom attribute");
 	newMsg.attribute("customName", "customValue");
 	newMsg.show();
@@ -18,6 +18,11 @@
 *    name:value pairs.
 *  - Message have a number of getter, setter methods for common attributes, and allow
 *    definition of other "custom" attributes.
+*  - toBinary() and fromBinary(...) provide a compact encoding for peers that
+*    negotiate it: a BinaryMarker byte and varint body length, then an
+*    attribute count and each attribute's key and value.  Common keys are
+*    sent as one byte tags, and every length is a varint, so values may
+*    contain newlines.
 *
 *  Required Files:
 *  ---------------
@@ -25,6 +30,8 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added binary encoding, toBinary and fromBinary
 *  ver 1: 6th April 2018
 *
 */
@@ -81,6 +88,9 @@ namespace MsgPassingCommunication
     using Attributes = std::unordered_map<Key, Value>;
     using Keys = std::vector<Key>;
 
+    static const char BinaryMarker = '\x02';
+    static const size_t MaxBinarySize = 16 * 1024 * 1024;
+
     Message();
     Message(EndPoint to, EndPoint from);
 
@@ -110,9 +120,17 @@ namespace MsgPassingCommunication
     void clear();
     std::string toString();
     static Message fromString(const std::string& src);
+    std::string toBinary();
+    static bool fromBinary(const char* pBody, size_t bytes, Message& msg);
+    static bool varintByte(char byte, size_t& value, size_t& shift);
     std::ostream& show(std::ostream& out = std::cout);
 
   private:
+    static size_t varintSize(size_t value);
+    static void appendVarint(std::string& dest, size_t value);
+    static bool readVarint(const char*& pData, const char* pEnd, size_t& value);
+    static size_t keyTag(const Key& key);
+
     Attributes attributes_;
     // name            : msgName
     // command         : msg Command
@@ -0,0 +1,257 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////
+// BufferPool.h - pool of page-aligned file transfer buffers       //
+//                                                                 //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                     //
+// Reference: Jim Fawcett                                          //
+// Application: RepositoryApp                                      //
+// Environment: C++ console                                        //
+// Platform: Lenovo T460                                           //
+// Operating System: Windows 10                                    //
+/////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package defines the BufferPool class.
+*  - acquire(bytes) returns a Buffer of at least bytes bytes, rounded
+*    up to whole pages and page aligned, reusing a released buffer of
+*    that size when the pool holds one.
+*  - Buffer is a move-only handle, owned by one transfer, that gives
+*    its memory back to the pool when destroyed.  Each transfer has its
+*    own buffer, so transfers on different connections run in parallel.
+*  - released buffers are kept for reuse until the pool holds
+*    maxPooledBytes(), after which they are freed.
+*  - stats() returns counts of buffers and bytes in use and pooled, the
+*    peak bytes in use, and how many acquires had to allocate.
+*  BufferPool::instance() returns the process-wide pool used by Comm.
+*
+*  Required Files:
+*  ---------------
+*  BufferPool.h
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17th October 2026
+*  - first release
+*/
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <new>
+#include <iterator>
+#include <utility>
+#include <malloc.h>
+
+namespace MsgPassingCommunication
+{
+  class BufferPool
+  {
+  public:
+    using byte = char;
+    static const size_t PageSize = 4096;
+
+    /////////////////////////////////////////////////////////////////
+    // Buffer class
+    // - move-only handle to pooled memory
+
+    class Buffer
+    {
+    public:
+      Buffer() {}
+      Buffer(const Buffer&) = delete;
+      Buffer& operator=(const Buffer&) = delete;
+      Buffer(Buffer&& buffer);
+      Buffer& operator=(Buffer&& buffer);
+      ~Buffer() { release(); }
+
+      byte* data() { return pData_; }
+      size_t size() { return size_; }
+      bool empty() { return pData_ == nullptr; }
+      void release();
+    private:
+      friend class BufferPool;
+      Buffer(BufferPool* pPool, byte* pData, size_t size) : pPool_(pPool), pData_(pData), size_(size) {}
+
+      BufferPool* pPool_ = nullptr;
+      byte* pData_ = nullptr;
+      size_t size_ = 0;
+    };
+
+    struct Stats
+    {
+      size_t buffersInUse = 0;
+      size_t bytesInUse = 0;
+      size_t peakBytesInUse = 0;
+      size_t buffersPooled = 0;
+      size_t bytesPooled = 0;
+      size_t acquires = 0;
+      size_t allocations = 0;
+    };
+
+    BufferPool() {}
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    ~BufferPool() { clear(); }
+
+    static BufferPool& instance();
+    Buffer acquire(size_t bytes);
+    Stats stats();
+    void maxPooledBytes(size_t bytes);
+    size_t maxPooledBytes();
+    void clear();
+  private:
+    void release(byte* pData, size_t size);
+    void trim();
+
+    std::mutex mtx_;
+    std::map<size_t, std::vector<byte*>> pooled_;
+    Stats stats_;
+    size_t maxPooledBytes_ = 16 * 1024 * 1024;
+  };
+  //----< take ownership of buffer's memory >------------------------
+
+  inline BufferPool::Buffer::Buffer(Buffer&& buffer)
+    : pPool_(buffer.pPool_), pData_(buffer.pData_), size_(buffer.size_)
+  {
+    buffer.pPool_ = nullptr;
+    buffer.pData_ = nullptr;
+    buffer.size_ = 0;
+  }
+  //----< release own memory, then take ownership of buffer's >------
+
+  inline BufferPool::Buffer& BufferPool::Buffer::operator=(Buffer&& buffer)
+  {
+    if (this != &buffer)
+    {
+      release();
+      std::swap(pPool_, buffer.pPool_);
+      std::swap(pData_, buffer.pData_);
+      std::swap(size_, buffer.size_);
+    }
+    return *this;
+  }
+  //----< give memory back to its pool, leaving buffer empty >-------
+
+  inline void BufferPool::Buffer::release()
+  {
+    if (pData_ != nullptr)
+      pPool_->release(pData_, size_);
+    pPool_ = nullptr;
+    pData_ = nullptr;
+    size_ = 0;
+  }
+  //----< return the single process-wide pool >----------------------
+
+  inline BufferPool& BufferPool::instance()
+  {
+    static BufferPool pool;
+    return pool;
+  }
+  //----< return buffer of at least bytes bytes, in whole pages >----
+  /*
+  *  - allocates outside the lock when no pooled buffer fits
+  */
+  inline BufferPool::Buffer BufferPool::acquire(size_t bytes)
+  {
+    size_t size = (bytes + PageSize - 1) / PageSize * PageSize;
+    if (size == 0)
+      size = PageSize;
+    byte* pData = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ++stats_.acquires;
+      auto iter = pooled_.find(size);
+      if (iter != pooled_.end() && iter->second.size() > 0)
+      {
+        pData = iter->second.back();
+        iter->second.pop_back();
+        --stats_.buffersPooled;
+        stats_.bytesPooled -= size;
+      }
+      else
+        ++stats_.allocations;
+      ++stats_.buffersInUse;
+      stats_.bytesInUse += size;
+      if (stats_.bytesInUse > stats_.peakBytesInUse)
+        stats_.peakBytesInUse = stats_.bytesInUse;
+    }
+    if (pData == nullptr)
+      pData = static_cast<byte*>(::_aligned_malloc(size, PageSize));
+    if (pData == nullptr)
+    {
+      release(nullptr, size);
+      throw std::bad_alloc();
+    }
+    return Buffer(this, pData, size);
+  }
+  //----< return buffer's memory to the pool >-----------------------
+  /*
+  *  - pData == nullptr only undoes the accounting of a failed acquire
+  */
+  inline void BufferPool::release(byte* pData, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    --stats_.buffersInUse;
+    stats_.bytesInUse -= size;
+    if (pData == nullptr)
+      return;
+    pooled_[size].push_back(pData);
+    ++stats_.buffersPooled;
+    stats_.bytesPooled += size;
+    trim();
+  }
+  //----< snapshot of pool accounting >------------------------------
+
+  inline BufferPool::Stats BufferPool::stats()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return stats_;
+  }
+  //----< set most bytes kept in released buffers >------------------
+
+  inline void BufferPool::maxPooledBytes(size_t bytes)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    maxPooledBytes_ = bytes;
+    trim();
+  }
+  //----< return most bytes kept in released buffers >---------------
+
+  inline size_t BufferPool::maxPooledBytes()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return maxPooledBytes_;
+  }
+  //----< free all released buffers >--------------------------------
+
+  inline void BufferPool::clear()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_t maxPooledBytes = maxPooledBytes_;
+    maxPooledBytes_ = 0;
+    trim();
+    maxPooledBytes_ = maxPooledBytes;
+  }
+  //----< free largest released buffers until under limit >----------
+  /*
+  *  - caller holds lock
+  */
+  inline void BufferPool::trim()
+  {
+    while (stats_.bytesPooled > maxPooledBytes_ && pooled_.size() > 0)
+    {
+      auto iter = std::prev(pooled_.end());
+      std::vector<byte*>& buffers = iter->second;
+      while (buffers.size() > 0 && stats_.bytesPooled > maxPooledBytes_)
+      {
+        ::_aligned_free(buffers.back());
+        buffers.pop_back();
+        --stats_.buffersPooled;
+        stats_.bytesPooled -= iter->first;
+      }
+      if (buffers.size() == 0)
+        pooled_.erase(iter);
+    }
+  }
+}
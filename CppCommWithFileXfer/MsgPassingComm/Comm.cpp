@@ -12,28 +12,62 @@
 *  Package Operations:
 *  -------------------
 *  This package defines Sender and Receiver classes.
-*  - Sender uses a SocketConnecter and supports connecting to multiple
-*    sequential endpoints and posting messages.
+*  - Sender keeps a pool of connections, one per endpoint, each with its
+*    own send queue and thread, and supports posting messages.
 *  - Receiver uses a SocketListener which returns a Socket on connection.
+*  - Files are sent in bulk, one header and one stream of large blocks
+*    per file, unless Sender::bulkTransfer(false) is called.
+*  - Sender offers binary message encoding when it connects, and uses it
+*    if the receiver accepts.  Receivers read both encodings.
+*  - Sender and Receiver queues are limited by high and low watermarks.
+*    Comm answers requests its full receive queue rejects with a
+*    "server busy" reply.
 *  It also defines a Comm class
 *  - Comm simply composes a Sender and a Receiver, exposing methods:
 *    postMessage(Message) and getMessage()
 *
 *  Required Files:
 *  ---------------
-*  Comm.h, Comm.cpp,
+*  Comm.h, Comm.cpp, BufferPool.h, Watermarks.h, Cpp11-MpscQueue.h,
 *  Sockets.h, Sockets.cpp,
 *  Message.h, Message.cpp,
 *  Utilities.h, Utilities.cpp
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.1 : 17th October 2026
+*  - ClientHandler reads message lines and file blocks through the
+*    socket's receive buffer, instead of one ::recv call per byte
+*  - added MessageParser and Comm::startPolled, which serve all
+*    connections from a few WSAPoll driven IoLoop threads
+*  - added bulk file transfer: Sender sends each file with TransmitFile
+*    after a single header, and receivers write blockSize blocks
+*    straight to disk
+*  - file blocks are read and written through page aligned buffers that
+*    each transfer acquires from BufferPool, replacing the shared global
+*    rwBuffer, so transfers on different connections run in parallel
+*  - added binary message encoding, negotiated when Sender connects
+*  - Sender keeps a pool of per-endpoint connections, each drained by
+*    its own thread and closed after idleTimeout, instead of
+*    reconnecting whenever the destination changes
+*  - messages are moved, not copied, through the send and receive
+*    queues, with Message&& overloads of postMessage
+*  - Receiver's queue is a lock-free MpscQueue, so connection handlers
+*    and IoLoops enQ received messages without contending for a lock
+*  - send and receive queues have high and low watermarks; a Comm
+*    whose receive queue is full replies "server busy" with retryAfter
+*  - trace messages are logged at debug level with LOG_WRITE, so they
+*    are neither built nor queued unless the logger is started
+*  - file transfer progress goes to the Diagnostics logger, not std::cout
+*  - the folder received files are saved in is chosen for each transfer,
+*    instead of being kept in a global shared by all connections
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1: 6th April 2018
 */
 
 #include "Comm.h"
+#include "BufferPool.h"
 #include "../Logger/Logger.h"
 #include "../Utilities/Utilities.h"
 #include "../Cpp11-BlockingQueue/Cpp11-BlockingQueue.h"
@@ -41,6 +75,9 @@
 #include <fstream>
 #include <functional>
 #include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
 #include <conio.h>
 #include <stdio.h>  /* defines FILENAME_MAX */
 #define WINDOWS  /* uncomment this line to use it for windows.*/ 
@@ -57,16 +94,51 @@ using namespace MsgPassingCommunication;
 using namespace Sockets;
 using SUtils = Utilities::StringHelper;
 
-std::string clientFilePath = "codeRepository/localClientFiles";
-std::string serverFilePath = "../codeRepository/remoteRepositoryFiles"; 
-const size_t BlockSize = 1024;
-Socket::byte rwBuffer[BlockSize];
+const std::string clientFilePath = "codeRepository/localClientFiles";
+const std::string serverFilePath = "../codeRepository/remoteRepositoryFiles";
 
+//----< enQ message, waiting or rejecting if queue is full >---------
+/*
+*  - file, quit, and busy messages always enter: a file has already
+*    been received, quit must reach the consumer, and a busy reply
+*    rejected again would bounce between two full queues
+*  - a rejected message is passed to the busy handler, without one
+*    the producer waits as it would with block
+*/
+void ReceiveQueue::enQ(Message&& msg)
+{
+  if (msg.containsKey("file") || msg.command() == "quit" || msg.value("error") == "server busy")
+    watermarks_.enterAlways();
+  else if (!watermarks_.enter(busy_ ? overflow_ : block))
+  {
+    LOG_WRITE(StaticLogger<1>, Logger::warning, "\n  -- receive queue full, rejecting ", msg.name());
+    busy_(std::move(msg));
+    return;
+  }
+  q_.enQ(std::move(msg));
+}
+//----< deQ message, waiting if queue is empty >---------------------
+
+Message ReceiveQueue::deQ()
+{
+  Message msg = q_.deQ();
+  watermarks_.leave();
+  return msg;
+}
+//----< set watermarks, highWater no more than queue capacity >------
+
+void ReceiveQueue::limits(size_t highWater, size_t lowWater, Overflow overflow)
+{
+  if (highWater > q_.capacity())
+    highWater = q_.capacity();
+  watermarks_.limits(highWater, lowWater);
+  overflow_ = overflow;
+}
 //----< constructor sets port >--------------------------------------
 
 Receiver::Receiver(EndPoint ep, const std::string& name) : listener(ep.port), rcvrName(name)
 {
-  StaticLogger<1>::write("\n  -- starting Receiver");
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- starting Receiver");
 }
 
 //----< Get current directory >------------------------------------------
@@ -79,7 +151,7 @@ inline std::string getCurrentWorkingDirectory(void) {
 
 //----< returns reference to receive queue >-------------------------
 
-BlockingQueue<Message>* Receiver::queue()
+ReceiveQueue* Receiver::queue()
 {
   return &rcvQ;
 }
@@ -100,116 +172,298 @@ void Receiver::stop()
 
 Message Receiver::getMessage()
 {
-  StaticLogger<1>::write("\n  -- " + rcvrName + " deQing message");
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ", rcvrName, " deQing message");
   return rcvQ.deQ();
 }
-//----< constructor initializes endpoint object >--------------------
+//----< constructor initializes sender name >------------------------
 
-Sender::Sender(const std::string& name) : sndrName(name)
-{
-  lastEP = EndPoint();  // used to detect change in destination
-}
-//----< destructor waits for send thread to terminate >--------------
+Sender::Sender(const std::string& name) : sndrName(name) {}
+
+//----< destructor waits for send and connection threads to end >---
 
 Sender::~Sender()
 {
   if (sendThread.joinable())
     sendThread.join();
+  stopConnections();
 }
-//----< starts send thread deQ, inspect, and send loop >-------------
-
+//----< starts send thread deQ, inspect, and dispatch loop >---------
+/*
+*  - each message is queued on the pooled connection to its endpoint,
+*    whose own thread sends it, so sends to different endpoints run
+*    in parallel and a reply to a known endpoint needs no reconnect
+*/
 void Sender::start()
 {
   std::function <void()> threadProc = [&]() {
     while (true)
     {
       Message msg = sndQ.deQ();
-      if (msg.containsKey("verbose"))
-      {
-        //::Beep(1000, 100);
-        //::Beep(1000, 100);
-        //::Beep(1000, 100);
-      }
       if (msg.command() == "quit")
       {
-        StaticLogger<1>::write("\n  -- send thread shutting down");
+        pending_.leave();
+        LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- send thread shutting down");
+        stopConnections();
         return;
       }
-      StaticLogger<1>::write("\n  -- " + sndrName + " send thread sending " + msg.name());
-      std::string msgStr = msg.toString();
-
-      if (msg.to().address != lastEP.address || msg.to().port != lastEP.port)
-      {
-        connecter.shutDown();
-        //connecter.close();
-        StaticLogger<1>::write("\n  -- attempting to connect to new endpoint: " + msg.to().toString());
-        if (!connect(msg.to()))
-        {
-          StaticLogger<1>::write("\n can't connect");
-          continue;
-        }
-        else
-        {
-          StaticLogger<1>::write("\n  connected to " + msg.to().toString());
-        }
-      }
-      if (msg.containsKey("file"))
-      {
-        sendFile(msg);
-      }
-      else
-      {
-        bool sendRslt = connecter.send(msgStr.length(), (Socket::byte*)msgStr.c_str());
-      }
+      LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ", sndrName, " send thread dispatching ", msg.name());
+      reapEvicted();
+      std::lock_guard<std::mutex> lock(poolMtx_);
+      EndPoint ep = msg.to();
+      connection(ep)->sendQ.enQ(std::move(msg));
     }
   };
   std::thread t(threadProc);
   sendThread = std::move(t);
 }
 //----< stops send thread by posting quit message >------------------
-
+/*
+*  - messages posted earlier are sent first
+*/
 void Sender::stop()
 {
   Message msg;
   msg.name("quit");
   msg.command("quit");
-  postMessage(msg);
-  connecter.shutDown();
+  postControl(std::move(msg));
 }
-//----< attempts to connect to endpoint ep >-------------------------
-
+//----< opens pooled connection to endpoint ep now >-----------------
+/*
+*  - otherwise the connection is opened when its first message is sent
+*/
 bool Sender::connect(EndPoint ep)
 {
-  lastEP = ep;
-  return connecter.connect(ep.address, ep.port);
+  ConnectionPtr pConn;
+  {
+    std::lock_guard<std::mutex> lock(poolMtx_);
+    pConn = connection(ep);
+  }
+  std::lock_guard<std::mutex> lock(pConn->mtx);
+  return pConn->connected || open(*pConn);
+}
+//----< number of pooled connections >-------------------------------
+
+size_t Sender::connections()
+{
+  std::lock_guard<std::mutex> lock(poolMtx_);
+  return pool_.size();
+}
+//----< find pooled connection to ep, creating it if needed >--------
+/*
+*  - caller holds poolMtx_
+*/
+Sender::ConnectionPtr Sender::connection(EndPoint ep)
+{
+  std::string key = ep.toString();
+  ConnectionPtr& pConn = pool_[key];
+  if (!pConn)
+  {
+    pConn = std::make_shared<Connection>();
+    pConn->ep = ep;
+    ConnectionPtr pNew = pConn;
+    pConn->thread = std::thread([this, pNew]() { drain(pNew); });
+  }
+  return pConn;
+}
+//----< connection thread sends queued messages until quit or idle >-
+
+void Sender::drain(ConnectionPtr pConn)
+{
+  std::chrono::milliseconds idle(idleTimeout_);
+  while (true)
+  {
+    Message msg;
+    if (!pConn->sendQ.deQ(msg, idle))
+    {
+      if (evict(pConn))
+        break;
+      continue;
+    }
+    if (msg.command() == "quit")
+      break;
+    std::lock_guard<std::mutex> lock(pConn->mtx);
+    if (!pConn->connected && !open(*pConn))
+    {
+      LOG_WRITE(StaticLogger<1>, Logger::warning, "\n can't connect");
+      pending_.leave();
+      continue;
+    }
+    LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ", sndrName, " connection thread sending ", msg.name());
+    if (msg.containsKey("file"))
+    {
+      sendFile(*pConn, std::move(msg));
+    }
+    else
+    {
+      std::string msgStr = encode(*pConn, msg);
+      if (!pConn->connecter.send(msgStr.length(), (Socket::byte*)msgStr.c_str()))
+        pConn->connected = false;
+    }
+    pending_.leave();
+  }
+  std::lock_guard<std::mutex> lock(pConn->mtx);
+  pConn->connecter.shutDown();
+}
+//----< remove idle connection from pool >---------------------------
+/*
+*  - fails if a message was queued while the connection timed out
+*  - evicted connections are joined later by reapEvicted
+*/
+bool Sender::evict(ConnectionPtr pConn)
+{
+  std::lock_guard<std::mutex> lock(poolMtx_);
+  if (pConn->sendQ.size() > 0)
+    return false;
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- evicting idle connection to ", pConn->ep.toString());
+  pool_.erase(pConn->ep.toString());
+  evicted_.push_back(pConn);
+  return true;
+}
+//----< join threads of evicted connections >------------------------
+
+void Sender::reapEvicted()
+{
+  std::vector<ConnectionPtr> evicted;
+  {
+    std::lock_guard<std::mutex> lock(poolMtx_);
+    evicted.swap(evicted_);
+  }
+  for (auto& pConn : evicted)
+    pConn->thread.join();
+}
+//----< send quit to every connection and join their threads >------
+
+void Sender::stopConnections()
+{
+  std::vector<ConnectionPtr> conns;
+  {
+    std::lock_guard<std::mutex> lock(poolMtx_);
+    for (auto& item : pool_)
+      conns.push_back(item.second);
+    pool_.clear();
+  }
+  Message quit;
+  quit.name("quit");
+  quit.command("quit");
+  for (auto& pConn : conns)
+    pConn->sendQ.enQ(quit);
+  for (auto& pConn : conns)
+    pConn->thread.join();
+  reapEvicted();
+}
+//----< connects to conn's endpoint, replacing any old socket >------
+/*
+*  - offers binary encoding, unless binaryEncoding(false) was called
+*  - caller holds conn.mtx
+*/
+bool Sender::open(Connection& conn)
+{
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- attempting to connect to endpoint: ", conn.ep.toString());
+  conn.connecter.shutDown();
+  conn.connecter.close();
+  conn.binary = false;
+  conn.connected = conn.connecter.connect(conn.ep.address, conn.ep.port);
+  if (!conn.connected)
+    return false;
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  connected to ", conn.ep.toString());
+  if (offerBinary_)
+    conn.binary = negotiate(conn);
+  return true;
 }
-//----< posts message to send queue >--------------------------------
+//----< offer binary encoding, returning true if receiver accepts >--
+/*
+*  - receivers reply to the offer on the same connection, and don't
+*    post it to their receive queue
+*  - a receiver that doesn't reply within NegotiateTimeout millisec
+*    is sent text messages
+*/
+bool Sender::negotiate(Connection& conn)
+{
+  Message offer;
+  offer.name("negotiate");
+  offer.command("negotiate");
+  offer.attribute("encoding", "binary");
+  std::string offerStr = offer.toString();
+  if (!conn.connecter.send(offerStr.length(), (Socket::byte*)offerStr.c_str()))
+    return false;
+  if (!conn.connecter.waitForData(NegotiateTimeout, 10))
+    return false;
+  std::string replyStr, line;
+  do
+  {
+    line = conn.connecter.readLine();
+    replyStr += line;
+  } while (line.length() >= 2);
+  return Message::fromString(replyStr).value("encoding") == "binary";
+}
+//----< encoding negotiated with conn's receiver >-------------------
 
-void Sender::postMessage(Message msg)
+std::string Sender::encode(Connection& conn, Message& msg)
+{
+  return conn.binary ? msg.toBinary() : msg.toString();
+}
+//----< posts copy of message to send queue >------------------------
+/*
+*  - returns false if the queue is full and overflow is reject
+*/
+bool Sender::postMessage(const Message& msg)
 {
+  if (!pending_.enter(overflow_))
+    return false;
   sndQ.enQ(msg);
+  return true;
 }
-//----< sends binary file >------------------------------------------
+//----< moves message to send queue >--------------------------------
+
+bool Sender::postMessage(Message&& msg)
+{
+  if (!pending_.enter(overflow_))
+    return false;
+  sndQ.enQ(std::move(msg));
+  return true;
+}
+//----< moves control message to send queue, even if full >---------
 /*
-*  - not implemented yet
+*  - used for quit and busy replies, which must not wait on the
+*    messages they are sent to relieve
 */
-bool Sender::sendFile(Message msg)
+void Sender::postControl(Message&& msg)
+{
+  pending_.enterAlways();
+  sndQ.enQ(std::move(msg));
+}
+//----< limit messages posted but not yet sent >---------------------
+
+void Sender::limits(size_t highWater, size_t lowWater, Overflow overflow)
+{
+  pending_.limits(highWater, lowWater);
+  overflow_ = overflow;
+}
+//----< sends files named in msg's file attribute >------------------
+/*
+*  - each file is sent by sendBulk, or by sendBlocks if bulk transfer
+*    is turned off
+*  - the send folder is chosen per call, since connection threads send
+*    files in parallel
+*/
+bool Sender::sendFile(Connection& conn, Message msg)
 {
 	if (!msg.containsKey("file"))
 		return false;
-	std::cout << "\nDemonstrating requirement#6: to send and receive blocks of bytes to support file transfer";
-	std::cout << "\nAbout to transfer a file\n";
+	LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement#6: to send and receive blocks of bytes to support file transfer");
+	LOG_WRITE(Diagnostics, Logger::debug, "\nAbout to transfer a file\n");
 	std::string dir = getCurrentWorkingDirectory();
+	std::string filePath = serverFilePath;
 	size_t val = dir.find("ServerPrototype");
 	if (val == std::string::npos)
-		serverFilePath = "codeRepository/remoteRepositoryFiles";
+		filePath = "codeRepository/remoteRepositoryFiles";
 	if (msg.command() == "checkIn") {
-		std::cout << "\nsendFile checkin demonstration";
+		LOG_WRITE(Diagnostics, Logger::debug, "\nsendFile checkin demonstration");
 		size_t val = dir.find("Debug");
 		if (val != std::string::npos)
-			serverFilePath = "../../../../codeRepository/localClientFiles";
+			filePath = "../../../../codeRepository/localClientFiles";
 		else
-			serverFilePath = clientFilePath;
+			filePath = clientFilePath;
 	}
 	std::string files = msg.file();
 	std::string file;
@@ -217,28 +471,87 @@ bool Sender::sendFile(Message msg)
 	while ((pos = files.find(':')) != std::string::npos) {
 		file = files.substr(0, pos);
 		files.erase(0, pos + 1);
-		std::string fileSpec = serverFilePath + "/" + file;
-		std::cout << "\nreceivefile fileSpec::" << fileSpec;
-		std::ifstream sendFile(fileSpec, std::ios::binary);
-		if (!sendFile.good())
+		std::string fileSpec = filePath + "/" + file;
+		LOG_WRITE(Diagnostics, Logger::debug, "\nreceivefile fileSpec::", fileSpec);
+		bool sent = bulk_ ? sendBulk(conn, msg, fileSpec) : sendBlocks(conn, msg, fileSpec);
+		if (!sent)
 			return false;
-		while (true)
-		{
-			sendFile.read(rwBuffer, BlockSize);
-			size_t blockSize = (size_t)sendFile.gcount();
-			msg.contentLength(blockSize);
-			std::string msgString = msg.toString();
-			connecter.sendString(msgString);
-			if (blockSize == 0)
-				break;
-			connecter.send(blockSize, rwBuffer);
-		}
-		sendFile.close();
-		std::cout << "\nTransferring of file done\n";
+		LOG_WRITE(Diagnostics, Logger::debug, "\nTransferring of file done\n");
 	}
-	
-	  
-	  return true;
+	return true;
+}
+//----< sends file as one header followed by the whole file >--------
+/*
+*  - header's content-length is the file size
+*  - if sending fails part way through the file, the receiver can't
+*    find the next header, so the connection is shut down and the
+*    next message reconnects
+*/
+bool Sender::sendBulk(Connection& conn, Message& msg, const std::string& fileSpec)
+{
+	std::ifstream sendFile(fileSpec, std::ios::binary | std::ios::ate);
+	if (!sendFile.good())
+		return false;
+	size_t fileSize = (size_t)sendFile.tellg();
+	sendFile.close();
+	msg.attribute("transfer", "bulk");
+	msg.contentLength(fileSize);
+	if (conn.connecter.sendString(encode(conn, msg)) &&
+		(fileSize == 0 || conn.connecter.sendFile(fileSpec, fileSize, blockSize_)))
+		return true;
+	conn.connecter.shutDown();
+	conn.connected = false;
+	return false;
+}
+//----< sends file as a header per block, ending with an empty one >-
+
+bool Sender::sendBlocks(Connection& conn, Message& msg, const std::string& fileSpec)
+{
+	std::ifstream sendFile(fileSpec, std::ios::binary);
+	if (!sendFile.good())
+		return false;
+	BufferPool::Buffer buffer = BufferPool::instance().acquire(blockSize_);
+	while (true)
+	{
+		sendFile.read(buffer.data(), blockSize_);
+		size_t blockSize = (size_t)sendFile.gcount();
+		msg.contentLength(blockSize);
+		conn.connecter.sendString(encode(conn, msg));
+		if (blockSize == 0)
+			break;
+		conn.connecter.send(blockSize, buffer.data());
+	}
+	sendFile.close();
+	return true;
+}
+//----< return the folder msg's files are saved in >----------------
+/*
+*  - chosen for each transfer, since connections receive in parallel
+*/
+std::string selectReceivePath(Message& msg)
+{
+  std::string dir = getCurrentWorkingDirectory();
+  LOG_WRITE(Diagnostics, Logger::debug, "\nreceivefile dir::", dir);
+  if (msg.command() == "checkIn") {
+    LOG_WRITE(Diagnostics, Logger::debug, "\nreceiveFile checking demonstration");
+    if (dir.find("ServerPrototype") == std::string::npos)
+      return "codeRepository/remoteRepositoryFiles";
+    return serverFilePath;
+  }
+  if (dir.find("Debug") != std::string::npos)
+    return "../../../../codeRepository/localClientFiles";
+  return clientFilePath;
+}
+//----< reply to a sender's offer of binary encoding >---------------
+
+void acceptOffer(Socket& socket, Message& offer)
+{
+  Message reply;
+  reply.name("negotiate");
+  if (offer.value("encoding") == "binary")
+    reply.attribute("encoding", "binary");
+  std::string replyStr = reply.toString();
+  socket.send(replyStr.length(), (Socket::byte*)replyStr.c_str());
 }
 //----< callable object posts incoming message to rcvQ >-------------
 /*
@@ -250,67 +563,94 @@ class ClientHandler
 public:
   //----< acquire reference to shared rcvQ >-------------------------
 
-  ClientHandler(BlockingQueue<Message>* pQ, const std::string& name = "clientHandler") : pQ_(pQ), clientHandlerName(name)
+  ClientHandler(ReceiveQueue* pQ, const std::string& name = "clientHandler", size_t blockSize = DefaultBlockSize)
+    : pQ_(pQ), clientHandlerName(name), blockSize_(blockSize)
   {
-    StaticLogger<1>::write("\n  -- starting ClientHandler");
+    LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- starting ClientHandler");
   }
   //----< shutdown message >-----------------------------------------
 
   ~ClientHandler() 
   { 
-    StaticLogger<1>::write("\n  -- ClientHandler destroyed;"); 
+    LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ClientHandler destroyed;"); 
   }
-  //----< set BlockingQueue >----------------------------------------
+  //----< set receive queue >----------------------------------------
 
-  void setQueue(BlockingQueue<Message>* pQ)
+  void setQueue(ReceiveQueue* pQ)
   {
     pQ_ = pQ;
   }
-  //----< frame message string by reading bytes from socket >--------
+  //----< frame message string by reading lines from socket >--------
 
   std::string readMsg(Socket& socket)
   {
     std::string temp, msgString;
     while (socket.validState())
     {
-      temp = socket.recvString('\n');  // read attribute
+      temp = socket.readLine();        // read attribute
       msgString += temp;
       if (temp.length() < 2)           // if empty line we are done
         break;
     }
     return msgString;
   }
+  //----< read next message, in text or binary form >---------------
+  /*
+  *  - a binary frame starts with Message::BinaryMarker, which can't
+  *    start a text message
+  *  - returns false if the connection closed or a frame is malformed
+  */
+  bool readMessage(Socket& socket, Message& msg)
+  {
+    Socket::byte first;
+    if (!socket.readExact(1, &first))
+      return false;
+    if (first != Message::BinaryMarker)
+    {
+      std::string msgString(1, first);
+      if (first != '\n')
+        msgString += socket.readLine();
+      if (msgString.length() >= 2)
+        msgString += readMsg(socket);
+      msg = Message::fromString(msgString);
+      return true;
+    }
+    size_t bodySize = 0, shift = 0;
+    Socket::byte byte;
+    do
+    {
+      if (!socket.readExact(1, &byte))
+        return false;
+    } while (!Message::varintByte(byte, bodySize, shift));
+    if (bodySize == 0 || bodySize > Message::MaxBinarySize)
+      return false;
+    std::string body(bodySize, '\0');
+    if (!socket.readExact(bodySize, &body[0]))
+      return false;
+    return Message::fromBinary(body.data(), bodySize, msg);
+  }
   //----< receive file blocks >--------------------------------------
   /*
   *  - expects msg to contain file and contentLength attributes
   *  - expects to be connected to appropriate destination
   *  - these requirements are established in Sender::start()
+  *  - the block buffer grows if a sender's blocks are larger
   */
   bool receiveFile(Message msg)
   {
-	  std::cout << "\nDemonstrating requirement#6: to send and receive blocks of bytes to support file transfer";
-	  std::cout << "\nAbout to receive a file\n";
-	  std::string dir = getCurrentWorkingDirectory();
-	  std::cout << "\nreceivefile dir::" << dir;
-	  size_t val = dir.find("Debug");
-	  std::cout << "\nreceivefile val::" << val;
-	  if (val != std::string::npos)
-		  clientFilePath = "../../../../codeRepository/localClientFiles";
-      if (msg.command() == "checkIn") {
-		  std::cout << "\nreceiveFile checking demonstration";
-		  size_t val = dir.find("ServerPrototype");
-		  if (val == std::string::npos)
-			  clientFilePath = "codeRepository/remoteRepositoryFiles";
-		  else
-			  clientFilePath = serverFilePath;
-	  }
+	  LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement#6: to send and receive blocks of bytes to support file transfer");
+	  LOG_WRITE(Diagnostics, Logger::debug, "\nAbout to receive a file\n");
+	  std::string receivePath = selectReceivePath(msg);
+	  if (msg.value("transfer") == "bulk")
+	    return receiveBulk(std::move(msg), receivePath);
+	  BufferPool::Buffer buffer = BufferPool::instance().acquire(blockSize_);
 		std::string files = msg.file();
 	  std::string file;
 	  size_t pos = 0;
 	  while ((pos = files.find(':')) != std::string::npos) {
 		  file = files.substr(0, pos);
 		  files.erase(0, pos + 1);
-			std::string fileSpec = clientFilePath + "/" + file;
+			std::string fileSpec = receivePath + "/" + file;
 		  std::ofstream saveStream(fileSpec, std::ios::binary);
 		  if (!saveStream.good())
 		    return false;
@@ -319,24 +659,65 @@ public:
 			  size_t blockSize = msg.contentLength();
 			  if (blockSize == 0)
 				  break;
+			  if (blockSize > buffer.size())
+				  buffer = BufferPool::instance().acquire(blockSize);
 			  Socket::byte terminator;
-			  pSocket->recv(1, &terminator);
-			  pSocket->recv(blockSize, rwBuffer);
-			  saveStream.write(rwBuffer, blockSize);
-			  std::string msgString = readMsg(*pSocket);
-			  if (msgString.length() == 0)
+			  if (!pSocket->readExact(1, &terminator) || !pSocket->readExact(blockSize, buffer.data()))
+				  break;
+			  saveStream.write(buffer.data(), blockSize);
+			  if (!readMessage(*pSocket, msg))
 			    break;
-			  msg = Message::fromString(msgString);
 			  if (msg.contentLength() == 0)
 				  break;
 		  }
 		  saveStream.flush();
 		  saveStream.close();
 		  pQ_->enQ(msg);
-		  std::cout << "\nReceive file is done\n";
+		  LOG_WRITE(Diagnostics, Logger::debug, "\nReceive file is done\n");
 	  }
     return true;
   }
+  //----< receive files sent as one header and block stream each >---
+  /*
+  *  - msg is the first file's header, later headers are read here
+  *  - reads blockSize_ bytes at a time, writing each block straight
+  *    to an unbuffered file stream
+  *  - a file that can't be opened is still read, to reach the next
+  *    header
+  */
+  bool receiveBulk(Message msg, const std::string& receivePath)
+  {
+    BufferPool::Buffer buffer = BufferPool::instance().acquire(blockSize_);
+    std::string files = msg.file();
+    size_t pos = 0;
+    bool firstFile = true;
+    while ((pos = files.find(':')) != std::string::npos) {
+      std::string fileSpec = receivePath + "/" + files.substr(0, pos);
+      files.erase(0, pos + 1);
+      if (!firstFile && !readMessage(*pSocket, msg))
+        return false;
+      firstFile = false;
+      std::ofstream saveStream;
+      saveStream.rdbuf()->pubsetbuf(nullptr, 0);
+      saveStream.open(fileSpec, std::ios::binary);
+      Socket::byte terminator;
+      if (!pSocket->readExact(1, &terminator))
+        return false;
+      size_t bytesLeft = msg.contentLength();
+      while (bytesLeft > 0)
+      {
+        size_t bytes = (std::min)(bytesLeft, blockSize_);
+        if (!pSocket->readExact(bytes, buffer.data()))
+          return false;
+        saveStream.write(buffer.data(), bytes);
+        bytesLeft -= bytes;
+      }
+      saveStream.close();
+      pQ_->enQ(std::move(msg));
+      LOG_WRITE(Diagnostics, Logger::debug, "\nReceive file is done\n");
+    }
+    return true;
+  }
   //----< reads messages from socket and enQs in rcvQ >--------------
 
   void operator()(Socket socket)
@@ -344,37 +725,307 @@ public:
     pSocket = &socket;
     while (socket.validState())
     {
-      std::string msgString = readMsg(socket);
-      if (msgString.length() == 0)
+      Message msg;
+      if (!readMessage(socket, msg))
       {
         // invalid message
         break;
       }
-      Message msg = Message::fromString(msgString);
-      StaticLogger<1>::write("\n  -- " + clientHandlerName + " RecvThread read message: " + msg.name());
+      LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ", clientHandlerName, " RecvThread read message: ", msg.name());
+      if (msg.command() == "negotiate")
+      {
+        acceptOffer(socket, msg);
+        continue;
+      }
       if (msg.containsKey("file"))
       {
         receiveFile(msg);
       }
-      pQ_->enQ(msg);
+      bool quit = msg.command() == "quit";
+      pQ_->enQ(std::move(msg));
       //std::cout << "\n  -- message enqueued in rcvQ";
-      if (msg.command() == "quit")
+      if (quit)
         break;
     }
-    StaticLogger<1>::write("\n  -- terminating ClientHandler thread");
+    LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- terminating ClientHandler thread");
   }
 private:
-  BlockingQueue<Message>* pQ_;
+  ReceiveQueue* pQ_;
   std::string clientHandlerName;
+  size_t blockSize_;
   Socket* pSocket = nullptr;
 };
 
-Comm::Comm(EndPoint ep, const std::string& name) : rcvr(ep, name), sndr(name), commName(name) {}
+/////////////////////////////////////////////////////////////////////
+// MessageParser class
+// - per-connection state machine used by Receiver::startPolled
+// - frames messages and file blocks from bytes as they arrive, in
+//   the format ClientHandler reads, and posts messages to rcvQ
+// - a file transfer posts one message when each file is complete
+// - file bytes are written through a blockSize byte stream buffer,
+//   so they reach the disk in blockSize writes
+// - the stream buffer comes from BufferPool and is held only while a
+//   file transfer is in progress, so idle connections hold none
+// - binary frames are collected into one reused string and decoded
+//   when complete
+
+class MessageParser : public ConnectionHandler
+{
+public:
+  MessageParser(ReceiveQueue* pQ, const std::string& name = "messageParser", size_t blockSize = DefaultBlockSize)
+    : pQ_(pQ), parserName(name), blockSize_(blockSize) {}
+  bool onData(Socket& socket, const Socket::byte* pData, size_t bytes) override;
+  void onClose(Socket& socket) override;
+private:
+  enum State { header, terminator, block, frameLength, frame };
+  size_t parseHeader(const Socket::byte* pData, size_t bytes);
+  void onFrameLength();
+  void onFrame();
+  void onHeader();
+  void onMessage();
+  void openFile();
+  void endFile();
+
+  ReceiveQueue* pQ_;
+  std::string parserName;
+  State state_ = header;
+  Socket* pSocket_ = nullptr;
+  std::string msgString_;
+  size_t lineLength_ = 0;
+  std::string frame_;
+  size_t frameLeft_ = 0;
+  size_t shift_ = 0;
+  Message msg_;
+  std::string receivePath_;
+  size_t blockLeft_ = 0;
+  bool bulk_ = false;
+  size_t blockSize_;
+  BufferPool::Buffer writeBuffer_;
+  std::ofstream saveStream_;
+  std::vector<std::string> files_;
+  size_t fileIndex_ = 0;
+  bool quit_ = false;
+};
+//----< consume bytes read from connection >-------------------------
+/*
+*  - returns false after a quit message or a malformed binary frame,
+*    so the connection is closed
+*/
+bool MessageParser::onData(Socket& socket, const Socket::byte* pData, size_t bytes)
+{
+  pSocket_ = &socket;
+  while (bytes > 0 && !quit_)
+  {
+    size_t used = 1;
+    switch (state_)
+    {
+    case header:
+      used = parseHeader(pData, bytes);
+      break;
+    case terminator:
+      state_ = block;
+      break;
+    case block:
+      used = (std::min)(bytes, blockLeft_);
+      saveStream_.write(pData, used);
+      blockLeft_ -= used;
+      if (blockLeft_ == 0)
+      {
+        state_ = header;
+        if (bulk_)
+          endFile();
+      }
+      break;
+    case frameLength:
+      if (Message::varintByte(*pData, frameLeft_, shift_))
+        onFrameLength();
+      break;
+    case frame:
+      used = (std::min)(bytes, frameLeft_);
+      frame_.append(pData, used);
+      frameLeft_ -= used;
+      if (frameLeft_ == 0)
+        onFrame();
+      break;
+    }
+    pData += used;
+    bytes -= used;
+  }
+  return !quit_;
+}
+//----< append header lines, up to and including a blank line >------
+/*
+*  - skips the terminator that follows a file block's last header
+*  - switches to reading a binary frame if one starts here
+*  - returns number of bytes used
+*/
+size_t MessageParser::parseHeader(const Socket::byte* pData, size_t bytes)
+{
+  size_t used = 0;
+  if (msgString_.empty())
+  {
+    while (used < bytes && pData[used] == '\0')
+      ++used;
+    if (used < bytes && pData[used] == Message::BinaryMarker)
+    {
+      state_ = frameLength;
+      frameLeft_ = 0;
+      shift_ = 0;
+      return used + 1;
+    }
+  }
+  while (used < bytes)
+  {
+    const void* pNewline = ::memchr(pData + used, '\n', bytes - used);
+    size_t end = bytes;
+    if (pNewline != nullptr)
+      end = static_cast<const Socket::byte*>(pNewline) - pData + 1;
+    msgString_.append(pData + used, end - used);
+    lineLength_ += end - used;
+    used = end;
+    if (pNewline == nullptr)
+      break;
+    bool blankLine = lineLength_ < 2;
+    lineLength_ = 0;
+    if (blankLine)
+    {
+      onHeader();
+      break;
+    }
+  }
+  return used;
+}
+//----< start collecting binary frame of frameLeft_ bytes >----------
+
+void MessageParser::onFrameLength()
+{
+  if (frameLeft_ == 0 || frameLeft_ > Message::MaxBinarySize)
+  {
+    quit_ = true;
+    return;
+  }
+  frame_.clear();
+  frame_.reserve(frameLeft_);
+  state_ = frame;
+}
+//----< decode complete binary frame >-------------------------------
+
+void MessageParser::onFrame()
+{
+  state_ = header;
+  if (!Message::fromBinary(frame_.data(), frame_.size(), msg_))
+  {
+    quit_ = true;
+    return;
+  }
+  onMessage();
+}
+//----< decode complete text header >--------------------------------
+
+void MessageParser::onHeader()
+{
+  msg_ = Message::fromString(msgString_);
+  msgString_.clear();
+  onMessage();
+}
+//----< post message, or start receiving its file block >------------
+/*
+*  - a bulk file is complete after its one block, other files after
+*    a header with no block
+*/
+void MessageParser::onMessage()
+{
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ", parserName, " IoLoop read message: ", msg_.name());
+  if (msg_.command() == "negotiate")
+  {
+    acceptOffer(*pSocket_, msg_);
+    return;
+  }
+  if (!msg_.containsKey("file"))
+  {
+    quit_ = msg_.command() == "quit";
+    pQ_->enQ(std::move(msg_));
+    return;
+  }
+  if (!saveStream_.is_open())
+    openFile();
+  bulk_ = msg_.value("transfer") == "bulk";
+  blockLeft_ = msg_.contentLength();
+  if (blockLeft_ > 0)
+    state_ = terminator;
+  else
+    endFile();
+}
+//----< open the next file named in msg's file attribute >-----------
+
+void MessageParser::openFile()
+{
+  if (files_.empty())
+  {
+    LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement#6: to send and receive blocks of bytes to support file transfer");
+    std::string files = msg_.file();
+    size_t pos = 0;
+    while ((pos = files.find(':')) != std::string::npos)
+    {
+      files_.push_back(files.substr(0, pos));
+      files.erase(0, pos + 1);
+    }
+    fileIndex_ = 0;
+    receivePath_ = selectReceivePath(msg_);
+  }
+  if (writeBuffer_.empty())
+    writeBuffer_ = BufferPool::instance().acquire(blockSize_);
+  saveStream_.rdbuf()->pubsetbuf(writeBuffer_.data(), blockSize_);
+  if (fileIndex_ < files_.size())
+    saveStream_.open(receivePath_ + "/" + files_[fileIndex_], std::ios::binary);
+}
+//----< close finished file and post its last message >--------------
+
+void MessageParser::endFile()
+{
+  saveStream_.close();
+  saveStream_.clear();
+  pQ_->enQ(std::move(msg_));
+  LOG_WRITE(Diagnostics, Logger::debug, "\nReceive file is done\n");
+  if (++fileIndex_ >= files_.size())
+  {
+    files_.clear();
+    writeBuffer_.release();
+  }
+}
+//----< discard partly received file >-------------------------------
+
+void MessageParser::onClose(Socket& socket)
+{
+  if (saveStream_.is_open())
+    saveStream_.close();
+  writeBuffer_.release();
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- ", parserName, " connection closed");
+}
+
+//----< starts listener's IoLoops, each running MessageParsers >-----
+
+void Receiver::startPolled(size_t numIoThreads)
+{
+  ReceiveQueue* pQ = &rcvQ;
+  std::string name = rcvrName;
+  size_t blockSize = blockSize_;
+  listener.startPolled([pQ, name, blockSize]() {
+    return std::unique_ptr<ConnectionHandler>(new MessageParser(pQ, name, blockSize));
+  }, numIoThreads);
+}
+
+//----< constructor answers rejected requests with busy replies >---
+
+Comm::Comm(EndPoint ep, const std::string& name) : rcvr(ep, name), sndr(name), commName(name)
+{
+  rcvr.queue()->onBusy([this](Message&& msg) { sndr.postControl(busyReply(std::move(msg))); });
+}
 
 void Comm::start()
 {
-  BlockingQueue<Message>* pQ = rcvr.queue();
-  ClientHandler* pCh = new ClientHandler(pQ, commName);
+  ReceiveQueue* pQ = rcvr.queue();
+  ClientHandler* pCh = new ClientHandler(pQ, commName, rcvr.blockSize());
   /*
     There is a trivial memory leak here.  
     This ClientHandler is a prototype used to make ClientHandler copies for each connection.
@@ -387,6 +1038,49 @@ void Comm::start()
   rcvr.start(*pCh);
   sndr.start();
 }
+//----< start, serving connections from numIoThreads IoLoops >-------
+
+void Comm::startPolled(size_t numIoThreads)
+{
+  rcvr.startPolled(numIoThreads);
+  sndr.start();
+}
+
+//----< set block size of sender and of receivers started later >----
+
+void Comm::blockSize(size_t bytes)
+{
+  sndr.blockSize(bytes);
+  rcvr.blockSize(bytes);
+}
+//----< limit messages posted but not yet sent >---------------------
+
+void Comm::sendLimits(size_t highWater, size_t lowWater, Overflow overflow)
+{
+  sndr.limits(highWater, lowWater, overflow);
+}
+//----< limit messages received but not yet retrieved >--------------
+/*
+*  - with reject, requests arriving while full get busy replies
+*/
+void Comm::receiveLimits(size_t highWater, size_t lowWater, Overflow overflow)
+{
+  rcvr.queue()->limits(highWater, lowWater, overflow);
+}
+//----< return rejected request to its sender, marked busy >--------
+/*
+*  - the sender can repost the reply, less error and retryAfter,
+*    after waiting retryAfter millisec
+*/
+Message Comm::busyReply(Message&& msg)
+{
+  EndPoint from = msg.from();
+  msg.from(msg.to());
+  msg.to(from);
+  msg.attribute("error", "server busy");
+  msg.attribute("retryAfter", Utilities::Converter<size_t>::toString(retryAfter_));
+  return std::move(msg);
+}
 
 void Comm::stop()
 {
@@ -394,9 +1088,14 @@ void Comm::stop()
   sndr.stop();
 }
 
-void Comm::postMessage(Message msg)
+bool Comm::postMessage(const Message& msg)
 {
-  sndr.postMessage(msg);
+  return sndr.postMessage(msg);
+}
+
+bool Comm::postMessage(Message&& msg)
+{
+  return sndr.postMessage(std::move(msg));
 }
 
 Message Comm::getMessage()
@@ -422,12 +1121,12 @@ void DemoSndrRcvr(const std::string& machineName)
 	SocketSystem ss;
   EndPoint ep1;  ep1.port = 9091;  ep1.address = "localhost";
   Receiver rcvr1(ep1);
-  BlockingQueue<Message>* pQ1 = rcvr1.queue();
+  ReceiveQueue* pQ1 = rcvr1.queue();
 	ClientHandler ch1(pQ1);
   rcvr1.start(ch1);
   EndPoint ep2;  ep2.port = 9092;  ep2.address = "localhost";
   Receiver rcvr2(ep2);
-  BlockingQueue<Message>* pQ2 = rcvr2.queue();
+  ReceiveQueue* pQ2 = rcvr2.queue();
   ClientHandler ch2(pQ2);
   rcvr2.start(ch2);
   Sender sndr;  sndr.start();
@@ -594,7 +1293,7 @@ void DemoClientServer()
 
     if (msg.containsKey("file"))  // is this a file message?
     {
-      if(msg.contentLength() == 0)
+      if(msg.contentLength() == 0 || msg.value("transfer") == "bulk")
         std::cout << "\n  " + comm.name() + " received file \"" + msg.file() + "\" from " + msg.name();
     }
     else  // non-file message
@@ -617,6 +1316,132 @@ void DemoClientServer()
   _getche();
 }
 
+/////////////////////////////////////////////////////////////////////
+// Test #4 - Demonstrates BufferPool reusing transfer buffers
+//           acquired by several concurrent transfers
+
+void DemoBufferPool()
+{
+  SUtils::title("Demonstrating BufferPool");
+  BufferPool pool;
+  std::vector<std::thread> transfers;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    transfers.push_back(std::thread([&pool]() {
+      for (size_t j = 0; j < 100; ++j)
+      {
+        BufferPool::Buffer buffer = pool.acquire(DefaultBlockSize);
+        ::memset(buffer.data(), 0, buffer.size());
+      }
+    }));
+  }
+  for (auto& transfer : transfers)
+    transfer.join();
+  BufferPool::Buffer buffer = pool.acquire(1000);
+  BufferPool::Stats stats = pool.stats();
+  std::cout << "\n  buffer of " << buffer.size() << " bytes is page aligned: "
+    << std::boolalpha << ((size_t)buffer.data() % BufferPool::PageSize == 0);
+  std::cout << "\n  acquires: " << stats.acquires << ", allocations: " << stats.allocations;
+  std::cout << "\n  in use: " << stats.buffersInUse << " buffers, " << stats.bytesInUse << " bytes";
+  std::cout << "\n  pooled: " << stats.buffersPooled << " buffers, " << stats.bytesPooled << " bytes";
+  std::cout << "\n  peak bytes in use: " << stats.peakBytesInUse;
+  Utilities::putline();
+}
+
+/////////////////////////////////////////////////////////////////////
+// Test #5 - Counts heap allocations per message round trip, first
+//           posting copies of a message, then moving messages, and
+//           reports the difference, over loopback sockets
+
+std::atomic<size_t> allocations(0);
+
+void* operator new(size_t bytes)
+{
+  ++allocations;
+  void* pMem = std::malloc(bytes > 0 ? bytes : 1);
+  if (pMem == nullptr)
+    throw std::bad_alloc();
+  return pMem;
+}
+
+void operator delete(void* pMem) noexcept
+{
+  std::free(pMem);
+}
+
+void DemoAllocations()
+{
+  SUtils::title("Demonstrating allocations per round trip");
+  EndPoint ep("localhost", 9893);
+  Comm comm(ep, "allocComm");
+  comm.start();
+  Message msg(ep, ep);
+  msg.name("checkIn request");
+  msg.command("checkInFiles");
+  msg.attribute("name", "Comm.h");
+  msg.attribute("description", "message-passing communication facility");
+  msg.attribute("categories", "comm");
+  msg.attribute("path", "MsgPassingComm");
+  comm.postMessage(msg);  // first message opens the connection
+  comm.getMessage();
+
+  const size_t trips = 100;
+  size_t before = allocations;
+  for (size_t i = 0; i < trips; ++i)
+  {
+    comm.postMessage(msg);
+    Message rcvd = comm.getMessage();
+  }
+  size_t copying = allocations - before;
+
+  std::vector<Message> msgs(trips, msg);
+  before = allocations;
+  for (auto& item : msgs)
+  {
+    comm.postMessage(std::move(item));
+    Message rcvd = comm.getMessage();
+  }
+  size_t moving = allocations - before;
+
+  std::cout << "\n  posting copies:  " << copying / trips << " allocations per round trip";
+  std::cout << "\n  posting moves:   " << moving / trips << " allocations per round trip";
+  std::cout << "\n  moving saves:    " << (copying > moving ? (copying - moving) / trips : 0) << " allocations per round trip";
+  comm.stop();
+  Utilities::putline();
+}
+
+/////////////////////////////////////////////////////////////////////
+// Test #6 - Demonstrates a full receive queue answering requests
+//           with busy replies
+
+void DemoBackpressure()
+{
+  SUtils::title("Demonstrating server busy replies");
+  EndPoint ep("localhost", 9894);
+  Comm comm(ep, "busyComm");
+  comm.receiveLimits(4, 2);
+  comm.start();
+  const size_t requests = 10;
+  for (size_t i = 0; i < requests; ++i)
+  {
+    Message msg(ep, ep);
+    msg.name("request #" + Utilities::Converter<size_t>::toString(i));
+    comm.postMessage(std::move(msg));
+  }
+  size_t accepted = 0, busy = 0;
+  for (size_t i = 0; i < requests; ++i)
+  {
+    Message msg = comm.getMessage();
+    if (msg.value("error") == "server busy")
+      ++busy;
+    else
+      ++accepted;
+  }
+  std::cout << "\n  accepted " << accepted << " requests, " << busy << " were told to retry";
+  comm.stop();
+  Utilities::putline();
+}
+
 Cosmetic cosmetic;
 
 int main()
@@ -636,6 +1461,9 @@ int main()
 
   //DemoSndrRcvr("Odin");  // replace "Odin" with your machine name
   //DemoCommClass("Odin");
+  DemoBufferPool();
+  DemoAllocations();
+  DemoBackpressure();
   DemoClientServer();
 
   return 0;
@@ -13,22 +13,55 @@
 *  Package Operations:
 *  -------------------
 *  This package defines Sender and Receiver classes.
-*  - Sender uses a SocketConnecter and supports connecting to multiple
-*    sequential endpoints and posting messages.
+*  - Sender keeps a pool of connections, one per endpoint.  Posted
+*    messages are dispatched to their endpoint's connection, which has
+*    its own send queue and thread, so sends to different endpoints run
+*    in parallel and replies to many clients reuse open connections.
+*    A connection idle for idleTimeout millisec is closed and removed.
 *  - Receiver uses a SocketListener which returns a Socket on connection.
+*    start(co) handles each connection on its own thread.  startPolled(n)
+*    handles all connections on n IoLoop threads, each connection framed
+*    by a MessageParser state machine, for servers with many idle clients.
+*  - Files are sent in bulk mode by default: one header per file, whose
+*    content-length is the file size, then the whole file sent in large
+*    blocks with Socket::sendFile and written straight to disk by the
+*    receiver.  bulkTransfer(false) sends the original header per block.
+*    Both sides' block sizes are set with blockSize(bytes).
+*  - Sender::connect offers binary message encoding to the receiver, and
+*    sends binary messages if it accepts.  binaryEncoding(false) keeps
+*    the text encoding.  Receivers accept both.
+*  - Receiver's queue is a bounded lock-free MpscQueue, filled by every
+*    connection's handler and emptied by the single getMessage caller.
+*  - Sender and Receiver queues have high and low Watermarks, unlimited
+*    by default.  Above the high watermark postMessage blocks, or with
+*    reject returns false, until the queue drains to the low watermark.
+*    A Comm whose receive queue rejects replies to each request it
+*    turns away with the request itself, marked "error:server busy" and
+*    "retryAfter" millisec, so the client can back off and repost it.
 *  It also defines a Comm class
 *  - Comm simply composes a Sender and a Receiver, exposing methods:
 *    postMessage(Message) and getMessage()
+*  Messages are moved, not copied, from postMessage(Message&&) to the
+*  socket, and from the socket to getMessage's caller.
 *
 *  Required Files:
 *  ---------------
-*  Comm.h, Comm.cpp,
+*  Comm.h, Comm.cpp, BufferPool.h, Watermarks.h, Cpp11-MpscQueue.h,
 *  Sockets.h, Sockets.cpp,
 *  Message.h, Message.cpp,
 *  Utilities.h, Utilities.cpp
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.1 : 17th October 2026
+*  - added Receiver::startPolled and Comm::startPolled
+*  - added bulk file transfer and configurable block sizes
+*  - file transfers use buffers from BufferPool, not a shared global
+*  - added binary message encoding, negotiated by Sender::connect
+*  - added Sender's connection pool
+*  - Receiver queues messages in an MpscQueue
+*  - added postMessage(Message&&), messages are moved through queues
+*  - added send and receive queue watermarks and server busy replies
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1: 6th April 2018
@@ -36,15 +69,49 @@
 
 #include "../Message/Message.h"
 #include "../Cpp11-BlockingQueue/Cpp11-BlockingQueue.h"
+#include "../Cpp11-BlockingQueue/Cpp11-MpscQueue.h"
 #include "../Sockets/Sockets.h"
 #include "IComm.h"
+#include "Watermarks.h"
 #include <string>
 #include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <functional>
 
 using namespace Sockets;
 
 namespace MsgPassingCommunication
 {
+  const size_t DefaultBlockSize = 64 * 1024;
+  const size_t DefaultRetryAfter = 500;
+
+  ///////////////////////////////////////////////////////////////////
+  // ReceiveQueue class
+  // - filled by connection handlers, emptied by one getMessage caller
+  // - above the high watermark requests wait, or with reject are
+  //   handed to the busy handler; file and quit messages always enter
+
+  class ReceiveQueue
+  {
+  public:
+    using BusyHandler = std::function<void(Message&&)>;
+
+    void enQ(Message&& msg);
+    void enQ(const Message& msg) { enQ(Message(msg)); }
+    Message deQ();
+    size_t size() { return q_.size(); }
+    void limits(size_t highWater, size_t lowWater, Overflow overflow);
+    void onBusy(BusyHandler busy) { busy_ = busy; }
+  private:
+    MpscQueue<Message> q_;
+    Watermarks watermarks_;
+    Overflow overflow_ = block;
+    BusyHandler busy_;
+  };
+
   ///////////////////////////////////////////////////////////////////
   // Receiver class
 
@@ -54,13 +121,17 @@ namespace MsgPassingCommunication
     Receiver(EndPoint ep, const std::string& name = "Receiver");
     template<typename CallableObject>
     void start(CallableObject& co);
+    void startPolled(size_t numIoThreads);
     void stop();
     Message getMessage();
-    BlockingQueue<Message>* queue();
+    ReceiveQueue* queue();
+    void blockSize(size_t bytes) { blockSize_ = bytes; }
+    size_t blockSize() { return blockSize_; }
   private:
-	  BlockingQueue<Message> rcvQ;
+	  ReceiveQueue rcvQ;
     SocketListener listener;
     std::string rcvrName;
+    size_t blockSize_ = DefaultBlockSize;
   };
 
   ///////////////////////////////////////////////////////////////////
@@ -74,14 +145,53 @@ namespace MsgPassingCommunication
     void start();
     void stop();
     bool connect(EndPoint ep);
-    void postMessage(Message msg);
+    bool postMessage(const Message& msg);
+    bool postMessage(Message&& msg);
+    void postControl(Message&& msg);
+    void limits(size_t highWater, size_t lowWater, Overflow overflow);
+    size_t pending() { return pending_.count(); }
+    void blockSize(size_t bytes) { blockSize_ = bytes; }
+    void bulkTransfer(bool bulk) { bulk_ = bulk; }
+    void binaryEncoding(bool offer) { offerBinary_ = offer; }
+    void idleTimeout(size_t millisec) { idleTimeout_ = millisec; }
+    size_t connections();
+    static const size_t NegotiateTimeout = 1000;
   private:
-  	bool sendFile(Message msg);
+    struct Connection
+    {
+      EndPoint ep;
+      BlockingQueue<Message> sendQ;
+      std::thread thread;
+      std::mutex mtx;
+      SocketConnecter connecter;
+      bool connected = false;
+      bool binary = false;
+    };
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    ConnectionPtr connection(EndPoint ep);
+    void drain(ConnectionPtr pConn);
+    bool evict(ConnectionPtr pConn);
+    void reapEvicted();
+    void stopConnections();
+    bool open(Connection& conn);
+    bool negotiate(Connection& conn);
+    std::string encode(Connection& conn, Message& msg);
+  	bool sendFile(Connection& conn, Message msg);
+    bool sendBulk(Connection& conn, Message& msg, const std::string& fileSpec);
+    bool sendBlocks(Connection& conn, Message& msg, const std::string& fileSpec);
 	  BlockingQueue<Message> sndQ;
-    SocketConnecter connecter;
     std::thread sendThread;
-    EndPoint lastEP;
+    std::mutex poolMtx_;
+    std::unordered_map<std::string, ConnectionPtr> pool_;
+    std::vector<ConnectionPtr> evicted_;
     std::string sndrName;
+    size_t blockSize_ = DefaultBlockSize;
+    size_t idleTimeout_ = 30000;
+    bool bulk_ = true;
+    bool offerBinary_ = true;
+    Watermarks pending_;
+    Overflow overflow_ = block;
   };
 
   class Comm : public IComm
@@ -89,15 +199,24 @@ namespace MsgPassingCommunication
   public:
     Comm(EndPoint ep, const std::string& name = "Comm");
     void start();
+    void startPolled(size_t numIoThreads = 2);
     void stop();
-    void postMessage(Message msg);
+    void blockSize(size_t bytes);
+    void sendLimits(size_t highWater, size_t lowWater, Overflow overflow = block);
+    void receiveLimits(size_t highWater, size_t lowWater, Overflow overflow = reject);
+    void retryAfter(size_t millisec) { retryAfter_ = millisec; }
+    bool postMessage(const Message& msg);
+    bool postMessage(Message&& msg);
     Message getMessage();
     std::string name();
   private:
+    Message busyReply(Message&& msg);
+
     Sender sndr;
     Receiver rcvr;
     std::string commName;
     Sockets::SocketSystem socksys_;
+    size_t retryAfter_ = DefaultRetryAfter;
   };
 
   inline IComm* IComm::create(const std::string& machineAddress, size_t port)
@@ -13,10 +13,14 @@
 *  Package Operations:
 *  -------------------
 *  This package provides the interface to be implmented.
-*
+*  postMessage has a Message&& overload that moves the message into
+*  the send queue instead of copying it.  It returns false if the send
+*  queue is full and rejects messages.
 *  
 *  Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - postMessage takes const Message& or Message&&, and returns bool
 *  ver 1: 6th April 2018
 */
 
@@ -31,7 +35,8 @@ namespace MsgPassingCommunication
     static IComm* create(const std::string& machineAddress, size_t port);
     virtual void start() = 0;
     virtual void stop() = 0;
-    virtual void postMessage(Message msg) = 0;
+    virtual bool postMessage(const Message& msg) = 0;
+    virtual bool postMessage(Message&& msg) = 0;
     virtual Message getMessage() = 0;
     virtual std::string name() = 0;
     virtual ~IComm() {}
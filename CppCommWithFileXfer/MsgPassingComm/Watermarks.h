@@ -0,0 +1,143 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////
+// Watermarks.h - high and low watermarks for a bounded queue      //
+//                                                                 //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                     //
+// Reference: Jim Fawcett                                          //
+// Application: RepositoryApp                                      //
+// Environment: C++ console                                        //
+// Platform: Lenovo T460                                           //
+// Operating System: Windows 10                                    //
+/////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package defines the Watermarks class, which counts items that
+*  have entered a queue, or any other stage of processing, and not yet
+*  left it.
+*  - when the count reaches the high watermark the stage is full, and
+*    stays full until the count falls to the low watermark, so a queue
+*    under load switches between accepting and refusing work rarely.
+*  - enter(block) waits while the stage is full, enter(reject) returns
+*    false instead.  enterAlways() counts an item even when full, for
+*    control messages that must not be held back.
+*  - leave() counts an item out, waking waiting threads when the count
+*    falls to the low watermark.
+*  Counting is lock-free; the mutex is only taken when the stage is
+*  full.  By default the watermarks are unlimited.
+*
+*  Required Files:
+*  ---------------
+*  Watermarks.h
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 17th October 2026
+*  - first release
+*/
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+
+namespace MsgPassingCommunication
+{
+  enum Overflow { block, reject };
+
+  class Watermarks
+  {
+  public:
+    static const size_t unlimited = (std::numeric_limits<size_t>::max)();
+
+    Watermarks(size_t highWater = unlimited, size_t lowWater = unlimited);
+    Watermarks(const Watermarks&) = delete;
+    Watermarks& operator=(const Watermarks&) = delete;
+
+    void limits(size_t highWater, size_t lowWater);
+    size_t highWater() { return highWater_; }
+    size_t lowWater() { return lowWater_; }
+    bool enter(Overflow overflow);
+    void enterAlways();
+    void leave();
+    size_t count() { return count_; }
+    bool full() { return full_; }
+  private:
+    void open();
+
+    std::atomic<size_t> highWater_;
+    std::atomic<size_t> lowWater_;
+    std::atomic<size_t> count_;
+    std::atomic<bool> full_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+  };
+  //----< initialize count and watermarks >--------------------------
+
+  inline Watermarks::Watermarks(size_t highWater, size_t lowWater)
+    : highWater_(highWater), lowWater_(lowWater), count_(0), full_(false)
+  {
+    limits(highWater, lowWater);
+  }
+  //----< change watermarks, lowWater is less than highWater >-------
+
+  inline void Watermarks::limits(size_t highWater, size_t lowWater)
+  {
+    if (highWater == 0)
+      highWater = 1;
+    highWater_ = highWater;
+    lowWater_ = (lowWater < highWater) ? lowWater : highWater - 1;
+    if (count_ >= highWater_)
+      full_ = true;
+    if (count_ <= lowWater_)
+      open();
+  }
+  //----< count an item in, unless full and overflow is reject >-----
+  /*
+  *  - with block, waits until the count falls to the low watermark
+  *  - full is raised before the count is checked again, and leave
+  *    lowers the count before checking full, so one of them always
+  *    sees the other and the stage can't stay full while empty
+  */
+  inline bool Watermarks::enter(Overflow overflow)
+  {
+    while (full_)
+    {
+      if (overflow == reject)
+        return false;
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this]() { return !full_; });
+    }
+    enterAlways();
+    return true;
+  }
+  //----< count an item in, even if full >---------------------------
+
+  inline void Watermarks::enterAlways()
+  {
+    if (++count_ < highWater_)
+      return;
+    full_ = true;
+    if (count_ <= lowWater_)
+      open();
+  }
+  //----< count an item out, reopening at the low watermark >--------
+
+  inline void Watermarks::leave()
+  {
+    if (--count_ <= lowWater_ && full_)
+      open();
+  }
+  //----< no longer full, wake threads waiting in enter >------------
+
+  inline void Watermarks::open()
+  {
+    bool wasFull = true;
+    if (!full_.compare_exchange_strong(wasFull, false))
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+    }
+    cv_.notify_all();
+  }
+}
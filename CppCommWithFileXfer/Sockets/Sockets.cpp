@@ -20,11 +20,19 @@
 *  - adds the ability to connect to a server
 *  SocketListener:
 *  - adds the ability to listen for connections on a dedicated thread
+*  - start(co) handles each connection on its own thread
+*  - startPolled(factory, n) instead makes accepted sockets non-blocking
+*    and spreads them over n IoLoops.  Each IoLoop is one thread that
+*    waits on all of its sockets with WSAPoll and passes the bytes read
+*    from each to that connection's ConnectionHandler, so thousands of
+*    mostly idle clients cost a few threads, not one each.
 *  - instances of this class are the only ones influenced by ipVer().
 *    clients will use whatever protocol the server provides.
 *  SocketSystem:
 *  - Loads and unloads winsock2 library.
 *  - Declared once at beginning of execution
+*  It also provides RingBuffer, the fixed size circular byte buffer used
+*  by Socket.
 *
 *  Required Files:
 *  ---------------
@@ -35,6 +43,14 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added RingBuffer and buffered readLine, readUntil, and readExact
+*  - recvString, recv, and recvStream read through the receive buffer
+*  - added ConnectionHandler, IoLoop, and SocketListener::startPolled
+*  - added Socket::sendFile
+*  - waitForData counts its own checks, instead of all calls' checks
+*  - IoLoop waits in WSAPoll on a wake socket as well as its connections
+*  - SocketListener joins startPolled's listen thread, instead of detaching it
 *  ver 1: 6th April 2018
 */
 
@@ -45,6 +61,8 @@
 #include <memory>
 #include <functional>
 #include <exception>
+#include <cstring>
+#include <algorithm>
 #include "../Utilities/Utilities.h"
 
 using namespace Sockets;
@@ -73,6 +91,78 @@ SocketSystem::~SocketSystem()
   Show::write("\n  -- Socket System cleaning up\n");
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// RingBuffer class members
+
+//----< constructor allocates buffer >---------------------------------------
+
+RingBuffer::RingBuffer(size_t capacity) : buffer_(capacity > 0 ? capacity : 1) {}
+
+//----< offset of first byte equal to value, or npos >-----------------------
+/*
+*  - searches the two contiguous parts of the buffered bytes with memchr
+*/
+size_t RingBuffer::find(byte value)
+{
+  size_t first = (std::min)(count_, buffer_.size() - head_);
+  const byte* pStart = &buffer_[head_];
+  const void* pFound = ::memchr(pStart, value, first);
+  if (pFound != nullptr)
+    return static_cast<const byte*>(pFound) - pStart;
+  pFound = ::memchr(&buffer_[0], value, count_ - first);
+  if (pFound != nullptr)
+    return first + (static_cast<const byte*>(pFound) - &buffer_[0]);
+  return npos;
+}
+//----< move up to bytes from front of buffer into dest >--------------------
+/*
+*  - returns number of bytes moved
+*/
+size_t RingBuffer::read(size_t bytes, byte* dest)
+{
+  bytes = (std::min)(bytes, count_);
+  size_t first = (std::min)(bytes, buffer_.size() - head_);
+  ::memcpy(dest, &buffer_[head_], first);
+  ::memcpy(dest + first, &buffer_[0], bytes - first);
+  head_ = (head_ + bytes) % buffer_.size();
+  count_ -= bytes;
+  return bytes;
+}
+//----< move up to bytes from front of buffer onto end of dest >-------------
+
+size_t RingBuffer::read(size_t bytes, std::string& dest)
+{
+  bytes = (std::min)(bytes, count_);
+  size_t first = (std::min)(bytes, buffer_.size() - head_);
+  dest.append(&buffer_[head_], first);
+  dest.append(&buffer_[0], bytes - first);
+  head_ = (head_ + bytes) % buffer_.size();
+  count_ -= bytes;
+  return bytes;
+}
+//----< returns size of, and sets pFree to, largest contiguous free block >--
+/*
+*  - an empty buffer is rewound, so its whole capacity is free
+*/
+size_t RingBuffer::freeSpace(byte*& pFree)
+{
+  if (count_ == 0)
+    head_ = 0;
+  size_t tail = (head_ + count_) % buffer_.size();
+  pFree = &buffer_[tail];
+  if (count_ == buffer_.size())
+    return 0;
+  if (tail >= head_)
+    return buffer_.size() - tail;
+  return head_ - tail;
+}
+//----< add bytes written into free space to end of buffered bytes >--------
+
+void RingBuffer::commit(size_t bytes)
+{
+  count_ = (std::min)(count_ + bytes, buffer_.size());
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Socket class members
 
@@ -105,6 +195,7 @@ Socket::Socket(Socket&& s)
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
   ipver_ = s.ipver_;
+  std::swap(recvBuffer_, s.recvBuffer_);
   ZeroMemory(&hints, sizeof(hints));
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -118,6 +209,7 @@ Socket& Socket::operator=(Socket&& s)
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
   ipver_ = s.ipver_;
+  std::swap(recvBuffer_, s.recvBuffer_);
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
@@ -201,17 +293,7 @@ bool Socket::send(size_t bytes, byte* buffer)
 */
 bool Socket::recv(size_t bytes, byte* buffer)
 {
-  size_t bytesRecvd = 0, bytesLeft = bytes;
-  byte* pBuf = buffer;
-  while (bytesLeft > 0)
-  {
-    bytesRecvd = ::recv(socket_, pBuf, bytesLeft, 0);
-    if (socket_ == INVALID_SOCKET || bytesRecvd == 0)
-      return false;
-    bytesLeft -= bytesRecvd;
-    pBuf += bytesRecvd;
-  }
-  return true;
+  return readExact(bytes, buffer);
 }
 //----< sends a terminator terminated string >-------------------------------
 /*
@@ -233,39 +315,117 @@ bool Socket::sendString(const std::string& str, byte terminator)
   ::send(socket_, &terminator, 1, 0);
   return true;
 }
+//----< sends first bytes bytes of file, blockSize bytes per send >---------
+/*
+ * - TransmitFile sends from the system file cache, so the file is never
+ *   copied through a user mode buffer
+ * - a call sends at most 2,147,483,646 bytes, so larger files are sent
+ *   in several calls, each starting at an explicit file offset
+ * - returns false, sending nothing, if the file can't be opened or holds
+ *   fewer than bytes bytes
+ */
+bool Socket::sendFile(const std::string& fileSpec, size_t bytes, size_t blockSize)
+{
+  HANDLE hFile = ::CreateFileA(
+    fileSpec.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+  );
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+  const size_t maxPerCall = 2147483646;
+  LARGE_INTEGER fileSize;
+  bool ok = ::GetFileSizeEx(hFile, &fileSize) && (size_t)fileSize.QuadPart >= bytes;
+  size_t bytesSent = 0;
+  while (ok && bytesSent < bytes)
+  {
+    size_t count = (std::min)(bytes - bytesSent, maxPerCall);
+    LARGE_INTEGER offset;
+    offset.QuadPart = (LONGLONG)bytesSent;
+    ok = ::SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN) &&
+      ::TransmitFile(socket_, hFile, (DWORD)count, (DWORD)blockSize, NULL, NULL, 0);
+    bytesSent += count;
+  }
+  ::CloseHandle(hFile);
+  return ok;
+}
 //----< receives terminator terminated string >------------------------------
 /*
  * - Doesn't return until a terminator byte as been received.
  * - result includes terminator
- * ToDo:
- * - needs reads of one byte to be replaced by bulk reads into a
- *   stream buffer to improve efficiency.
- * - That will require building a circular buffer.
- * - performance seems acceptable, so won't do this now
  */
 std::string Socket::recvString(byte terminator)
 {
-  static const int buflen = 1;
-  char buffer[1];
+  return readUntil(terminator);
+}
+//----< refill receive buffer with one ::recv call >-------------------------
+/*
+ * - blocks until at least one byte arrives
+ * - returns false if connection closed or buffer is full
+ */
+bool Socket::fill()
+{
+  byte* pFree;
+  size_t space = recvBuffer_.freeSpace(pFree);
+  if (space == 0)
+    return false;
+  iResult = ::recv(socket_, pFree, (int)space, 0);
+  if (iResult == 0 || iResult == SOCKET_ERROR)
+    return false;
+  recvBuffer_.commit(iResult);
+  return true;
+}
+//----< receives bytes up to and including terminator >----------------------
+/*
+ * - if the connection closes first, returns bytes received so far,
+ *   without terminator
+ */
+std::string Socket::readUntil(byte terminator)
+{
   std::string str;
-  bool first = true;
   while (true)
   {
-    iResult = ::recv(socket_, buffer, buflen, 0);
-    if (iResult == 0 || iResult == INVALID_SOCKET)
+    size_t pos = recvBuffer_.find(terminator);
+    if (pos != RingBuffer::npos)
     {
-      //StaticLogger<1>::write("\n  -- invalid socket in Socket::recvString");
-      break;
+      recvBuffer_.read(pos + 1, str);
+      return str;
     }
-    if (buffer[0] == terminator)
+    recvBuffer_.read(recvBuffer_.size(), str);
+    if (!fill())
+      return str;
+  }
+}
+//----< receives one newline terminated line, including newline >-----------
+
+std::string Socket::readLine()
+{
+  return readUntil('\n');
+}
+//----< receives exactly bytes bytes into buffer >---------------------------
+/*
+ * - buffered bytes are used first, then blocks at least as large as
+ *   the receive buffer are read straight into buffer
+ * - returns false if connection closes before all bytes arrive
+ */
+bool Socket::readExact(size_t bytes, byte* buffer)
+{
+  size_t bytesRead = recvBuffer_.read(bytes, buffer);
+  while (bytesRead < bytes)
+  {
+    size_t bytesLeft = bytes - bytesRead;
+    if (bytesLeft >= recvBuffer_.capacity())
     {
-      // added 9/29/2017
-      str += terminator;
-      break;
+      iResult = ::recv(socket_, buffer + bytesRead, (int)bytesLeft, 0);
+      if (iResult == 0 || iResult == SOCKET_ERROR)
+        return false;
+      bytesRead += iResult;
+      continue;
     }
-    str += buffer[0];
+    if (!fill())
+      return false;
+    bytesRead += recvBuffer_.read(bytesLeft, buffer + bytesRead);
   }
-  return str;
+  return true;
 }
 //----< strips terminator character that recvString includes >---------------
 
@@ -283,26 +443,30 @@ size_t Socket::sendStream(size_t bytes, byte* pBuf)
 }
 //----< attempt to recv specified number of bytes, but may not send all >----
 /*
-* returns number of bytes actually received
+* returns number of bytes actually received, buffered bytes first
 */
 size_t Socket::recvStream(size_t bytes, byte* pBuf)
 {
+  if (!recvBuffer_.empty())
+    return recvBuffer_.read(bytes, pBuf);
   return ::recv(socket_, pBuf, bytes, 0);
 }
 //----< returns bytes available in recv buffer >-----------------------------
-
+/*
+ * - includes bytes already read into this socket's receive buffer
+ */
 size_t Socket::bytesWaiting()
 {
   unsigned long int ret;
   ::ioctlsocket(socket_, FIONREAD, &ret);
-  return (size_t)ret;
+  return (size_t)ret + recvBuffer_.size();
 }
 //----< waits for server data, checking every timeToCheck millisec >---------
 
 bool Socket::waitForData(size_t timeToWait, size_t timeToCheck)
 {
   size_t MaxCount = timeToWait / timeToCheck;
-  static size_t count = 0;
+  size_t count = 0;
   while (bytesWaiting() == 0)
   {
     if (++count < MaxCount)
@@ -328,6 +492,7 @@ SocketConnecter::SocketConnecter(SocketConnecter&& s) : Socket()
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
   ipver_ = s.ipver_;
+  std::swap(recvBuffer_, s.recvBuffer_);
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
@@ -340,6 +505,7 @@ SocketConnecter& SocketConnecter::operator=(SocketConnecter&& s)
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
   ipver_ = s.ipver_;
+  std::swap(recvBuffer_, s.recvBuffer_);
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
@@ -428,6 +594,7 @@ SocketListener::SocketListener(SocketListener&& s) : Socket()
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
   ipver_ = s.ipver_;
+  std::swap(recvBuffer_, s.recvBuffer_);
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
@@ -441,16 +608,19 @@ SocketListener& SocketListener::operator=(SocketListener&& s)
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
   ipver_ = s.ipver_;
+  std::swap(recvBuffer_, s.recvBuffer_);
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
   hints.ai_flags = s.hints.ai_flags;
   return *this;
 }
-//----< destructor announces destruction if Verbal(true) >-------------------
+//----< destructor stops and joins startPolled's threads >-------------------
 
 SocketListener::~SocketListener()
 {
+  stop_.exchange(true);
+  joinPolled();
   Show::write("\n  -- SocketListener instance destroyed");
 }
 //----< binds SocketListener to a network adddress on local machine >--------
@@ -462,7 +632,7 @@ bool SocketListener::bind()
   // Resolve the server address and port
 
   size_t uport = ::htons((u_short)port_);
-  StaticLogger<1>::write("\n  -- netstat uport = " + Utilities::Converter<size_t>::toString(uport));
+  LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- netstat uport = ", uport);
   std::string sPort = Conv<size_t>::toString(uport);
   iResult = getaddrinfo(NULL, sPort.c_str(), &hints, &result);
   if (iResult != 0) {
@@ -535,12 +705,225 @@ Socket SocketListener::accept()
   }
   return clientSocket;
 }
+//----< run listener, handing connections to IoLoops >----------------------
+/*
+*  - factory makes a ConnectionHandler for each accepted connection
+*  - each connection goes to the IoLoop serving the fewest connections
+*/
+bool SocketListener::startPolled(HandlerFactory factory, size_t numIoThreads)
+{
+  if (!bind())
+    return false;
+  if (!listen())
+    return false;
+  if (numIoThreads == 0)
+    numIoThreads = 1;
+  for (size_t i = 0; i < numIoThreads; ++i)
+  {
+    loops_.push_back(std::unique_ptr<IoLoop>(new IoLoop));
+    IoLoop* pLoop = loops_.back().get();
+    if (!pLoop->validState())
+    {
+      stop_.exchange(true);
+      joinPolled();
+      return false;
+    }
+    ioThreads_.push_back(std::thread([this, pLoop]() { pLoop->run(stop_); }));
+  }
+  listenThread_ = std::thread([this, factory]()
+  {
+    Show::write("\n  -- server waiting for connection");
+    while (!acceptFailed_)
+    {
+      if (stop_.load())
+        break;
+      Socket clientSocket = accept();
+      if (!clientSocket.validState())
+        continue;
+      Show::write("\n  -- server accepted connection");
+      IoLoop* pLoop = loops_[0].get();
+      for (auto& pNext : loops_)
+      {
+        if (pNext->connections() < pLoop->connections())
+          pLoop = pNext.get();
+      }
+      pLoop->add(std::move(clientSocket), factory());
+    }
+    Show::write("\n  -- Listen thread stopping");
+  });
+  return true;
+}
 //----< request SocketListener to stop accepting connections >---------------
-
+/*
+*  - after startPolled, returns once its listen and IoLoop threads exit
+*/
 void SocketListener::stop()
 {
   stop_.exchange(true);
-  sendString("Stop!");
+  if (listenThread_.joinable())
+    joinPolled();
+  else
+    sendString("Stop!");
+}
+//----< wake startPolled's threads and wait for them to exit >---------------
+/*
+*  - closing the listening socket fails the blocked accept call, so the
+*    listen thread is done with loops_ before they are destroyed
+*/
+void SocketListener::joinPolled()
+{
+  if (listenThread_.joinable())
+  {
+    ::closesocket(socket_);
+    listenThread_.join();
+    socket_ = INVALID_SOCKET;
+  }
+  for (auto& pLoop : loops_)
+    pLoop->wake();
+  for (auto& thrd : ioThreads_)
+  {
+    if (thrd.joinable())
+      thrd.join();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IoLoop class members
+
+//----< create the loopback datagram sockets used to wake the loop >---------
+
+IoLoop::IoLoop()
+{
+  sockaddr_in addr;
+  ZeroMemory(&addr, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+  int addrLen = sizeof(addr);
+  wakeRecv_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  wakeSend_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (::bind(wakeRecv_, (sockaddr*)&addr, addrLen) == SOCKET_ERROR ||
+    ::getsockname(wakeRecv_, (sockaddr*)&addr, &addrLen) == SOCKET_ERROR ||
+    ::connect(wakeSend_, (sockaddr*)&addr, addrLen) == SOCKET_ERROR)
+  {
+    int error = WSAGetLastError();
+    Show::write("\n  -- IoLoop wake socket failed with error: " + Conv<int>::toString(error));
+    ::closesocket(wakeRecv_);
+    wakeRecv_ = INVALID_SOCKET;
+    return;
+  }
+  u_long nonBlocking = 1;
+  ::ioctlsocket(wakeRecv_, FIONBIO, &nonBlocking);
+}
+//----< close wake sockets >-------------------------------------------------
+
+IoLoop::~IoLoop()
+{
+  if (wakeRecv_ != INVALID_SOCKET)
+    ::closesocket(wakeRecv_);
+  if (wakeSend_ != INVALID_SOCKET)
+    ::closesocket(wakeSend_);
+}
+//----< make socket non-blocking and queue it for the loop thread >----------
+
+void IoLoop::add(Socket&& socket, std::unique_ptr<ConnectionHandler> pHandler)
+{
+  u_long nonBlocking = 1;
+  ::ioctlsocket(socket, FIONBIO, &nonBlocking);
+  Connection conn{ std::move(socket), std::move(pHandler) };
+  std::lock_guard<std::mutex> lock(mtx_);
+  added_.push_back(std::move(conn));
+  ++count_;
+  wake();
+}
+//----< end the loop thread's wait in WSAPoll >------------------------------
+
+void IoLoop::wake()
+{
+  char signal = 'w';
+  ::send(wakeSend_, &signal, 1, 0);
+}
+//----< discard queued wake signals >----------------------------------------
+
+void IoLoop::drainWake()
+{
+  char signals[64];
+  while (::recv(wakeRecv_, signals, sizeof(signals), 0) > 0);
+}
+//----< number of connections added and not yet closed >--------------------
+
+size_t IoLoop::connections()
+{
+  return count_.load();
+}
+//----< wait for readable sockets and service them until stop is set >-------
+/*
+*  - fds[0] is the wake socket, fds[i + 1] is conns_[i], so WSAPoll
+*    waits without a timeout until a socket is readable or wake is called
+*  - a closed connection is swapped with the last one and popped, so its
+*    Socket destructor closes the handle
+*/
+void IoLoop::run(std::atomic<bool>& stop)
+{
+  std::vector<Socket::byte> buffer(RecvSize);
+  std::vector<WSAPOLLFD> fds;
+  while (!stop.load())
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      for (auto& conn : added_)
+        conns_.push_back(std::move(conn));
+      added_.clear();
+    }
+    fds.resize(conns_.size() + 1);
+    fds[0].fd = wakeRecv_;
+    fds[0].events = POLLRDNORM;
+    fds[0].revents = 0;
+    for (size_t i = 0; i < conns_.size(); ++i)
+    {
+      fds[i + 1].fd = conns_[i].socket;
+      fds[i + 1].events = POLLRDNORM;
+      fds[i + 1].revents = 0;
+    }
+    if (::WSAPoll(&fds[0], (ULONG)fds.size(), -1) == SOCKET_ERROR)
+    {
+      Show::write("\n  -- WSAPoll failed with error: " + Conv<int>::toString(WSAGetLastError()));
+      ::Sleep(ErrorBackoff);
+      continue;
+    }
+    if (fds[0].revents != 0)
+      drainWake();
+    for (size_t i = conns_.size(); i-- > 0;)
+    {
+      if (fds[i + 1].revents == 0 || service(conns_[i], &buffer[0]))
+        continue;
+      conns_[i].pHandler->onClose(conns_[i].socket);
+      std::swap(conns_[i], conns_.back());
+      conns_.pop_back();
+      --count_;
+    }
+  }
+  for (auto& conn : conns_)
+    conn.pHandler->onClose(conn.socket);
+  conns_.clear();
+}
+//----< pass bytes waiting on connection to its handler >--------------------
+/*
+*  - returns false if connection should be closed
+*/
+bool IoLoop::service(Connection& conn, Socket::byte* buffer)
+{
+  while (true)
+  {
+    int bytes = ::recv(conn.socket, buffer, (int)RecvSize, 0);
+    if (bytes == 0)
+      return false;
+    if (bytes == SOCKET_ERROR)
+      return ::WSAGetLastError() == WSAEWOULDBLOCK;
+    if (!conn.pHandler->onData(conn.socket, buffer, bytes))
+      return false;
+    if ((size_t)bytes < RecvSize)
+      return true;
+  }
 }
 
 #ifdef TEST_SOCKETS
@@ -795,6 +1178,30 @@ void clientTestBufferHandling(Socket& si)
     }
   }
 }
+//----< test RingBuffer wrap around >---------------------------------------
+
+bool testRingBuffer()
+{
+  Show::title("RingBuffer wrap around test");
+  RingBuffer ring(8);
+  std::string out;
+  Socket::byte* pFree;
+  size_t space = ring.freeSpace(pFree);
+  ::memcpy(pFree, "abcdef", 6);
+  ring.commit(6);
+  ring.read(4, out);                      // leaves "ef" at offsets 4, 5
+  space = ring.freeSpace(pFree);          // tail block, offsets 6, 7
+  ::memcpy(pFree, "gh", space);
+  ring.commit(space);
+  space = ring.freeSpace(pFree);          // wrapped block, offsets 0 - 3
+  ::memcpy(pFree, "\nij", 3);
+  ring.commit(3);
+  size_t pos = ring.find('\n');
+  ring.read(pos + 1, out);
+  Show::write("\n  read \"" + out.substr(0, out.size() - 1) + "\\n\", " +
+    Conv<size_t>::toString(ring.size()) + " bytes left");
+  return out == "abcdefgh\n" && ring.size() == 2;
+}
 //----< demonstration >------------------------------------------------------
 
 int main(int argc, char* argv[])
@@ -803,6 +1210,11 @@ int main(int argc, char* argv[])
   Show::start();
   Show::title("Testing Sockets", '=');
 
+  if (testRingBuffer())
+    Show::write("\n  ----RingBuffer test passed\n");
+  else
+    Show::write("\n  ----RingBuffer test failed\n");
+
   try
   {
     SocketSystem ss;
@@ -18,15 +18,30 @@
 *  - provides all the functionality necessary to handle server clients
 *  - created by SocketListener after accepting a request
 *  - usually passed to a client handling thread
+*  - buffers received bytes in a RingBuffer, so readLine, readUntil, and
+*    readExact make one ::recv call per buffer full, not one per byte.
+*    All of Socket's receive functions read through the buffer.
+*  - sendFile sends a file with TransmitFile, straight from the file
+*    cache, without copying it through a user mode buffer
 *  SocketConnecter:
 *  - adds the ability to connect to a server
 *  SocketListener:
 *  - adds the ability to listen for connections on a dedicated thread
+*  - start(co) handles each connection on its own thread
+*  - startPolled(factory, n) instead makes accepted sockets non-blocking
+*    and spreads them over n IoLoops.  Each IoLoop is one thread that
+*    waits on all of its sockets with WSAPoll and passes the bytes read
+*    from each to that connection's ConnectionHandler, so thousands of
+*    mostly idle clients cost a few threads, not one each.  An IoLoop
+*    also polls a loopback wake socket, so adding a connection or
+*    stopping the listener wakes it at once.
 *  - instances of this class are the only ones influenced by ipVer().
 *    clients will use whatever protocol the server provides.
 *  SocketSystem:
 *  - Loads and unloads winsock2 library.  
 *  - Declared once at beginning of execution
+*  It also provides RingBuffer, the fixed size circular byte buffer used
+*  by Socket.
 *
 *  Required Files:
 *  ---------------
@@ -37,6 +52,14 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added RingBuffer and buffered readLine, readUntil, and readExact
+*  - recvString, recv, and recvStream read through the receive buffer
+*  - added ConnectionHandler, IoLoop, and SocketListener::startPolled
+*  - added Socket::sendFile
+*  - listener trace messages logged at debug level with LOG_WRITE
+*  - startPolled's listen thread is joined by stop and the destructor
+*  - IoLoops wait on a wake socket, not a sleep, for new connections
 *  ver 1: 6th April 2018
 */
 
@@ -50,10 +73,15 @@
 #include <winsock2.h>     // Windows sockets, ver 2
 #include <WS2tcpip.h>     // support for IPv6 and other things
 #include <IPHlpApi.h>     // ip helpers
+#include <MSWSock.h>      // TransmitFile
 
 #include <vector>
 #include <string>
 #include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <functional>
 
 #include "../WindowsHelpers/WindowsHelpers.h"
 #include "../Utilities/Utilities.h"
@@ -61,6 +89,7 @@
 
 #pragma warning(disable:4522)
 #pragma comment(lib, "Ws2_32.lib")
+#pragma comment(lib, "Mswsock.lib")
 
 namespace Sockets
 {
@@ -77,6 +106,32 @@ namespace Sockets
     WSADATA wsaData;
   };
 
+  /////////////////////////////////////////////////////////////////////////////
+  // RingBuffer class
+  // - fixed capacity circular byte buffer
+  // - filled by writing into free space, then committing bytes written
+
+  class RingBuffer
+  {
+  public:
+    using byte = char;
+    static const size_t npos = static_cast<size_t>(-1);
+
+    explicit RingBuffer(size_t capacity = 8192);
+    size_t size() { return count_; }
+    size_t capacity() { return buffer_.size(); }
+    bool empty() { return count_ == 0; }
+    size_t find(byte value);
+    size_t read(size_t bytes, byte* dest);
+    size_t read(size_t bytes, std::string& dest);
+    size_t freeSpace(byte*& pFree);
+    void commit(size_t bytes);
+  private:
+    std::vector<byte> buffer_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   // Socket class
   // - used by server for client handling
@@ -105,8 +160,12 @@ namespace Sockets
     size_t sendStream(size_t bytes, byte* buffer);
     size_t recvStream(size_t bytes, byte* buffer);
     bool sendString(const std::string& str, byte terminator = '\0');
+    bool sendFile(const std::string& fileSpec, size_t bytes, size_t blockSize);
     std::string recvString(byte terminator = '\0');
     static std::string removeTerminator(const std::string& src);
+    std::string readUntil(byte terminator);
+    std::string readLine();
+    bool readExact(size_t bytes, byte* buffer);
     size_t bytesWaiting();
     bool waitForData(size_t timeToWait, size_t timeToCheck);
     bool shutDownSend();
@@ -117,11 +176,14 @@ namespace Sockets
     bool validState() { return socket_ != INVALID_SOCKET; }
 
   protected:
+    bool fill();
+
     WSADATA wsaData;
     ::SOCKET socket_;
     struct addrinfo *result = NULL, *ptr = NULL, hints;
     int iResult;
     IpVer ipver_ = IP4;
+    RingBuffer recvBuffer_;
   };
 
   /////////////////////////////////////////////////////////////////////////////
@@ -142,10 +204,60 @@ namespace Sockets
     bool connect(const std::string& ip, size_t port);
   };
 
+  /////////////////////////////////////////////////////////////////////////////
+  // ConnectionHandler class
+  // - interface for per-connection state driven by an IoLoop
+  // - onData returns false to have the IoLoop close the connection
+
+  class ConnectionHandler
+  {
+  public:
+    virtual ~ConnectionHandler() {}
+    virtual bool onData(Socket& socket, const Socket::byte* pData, size_t bytes) = 0;
+    virtual void onClose(Socket& socket) {}
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // IoLoop class
+  // - services many non-blocking sockets on the thread that calls run
+
+  class IoLoop
+  {
+  public:
+    static const size_t RecvSize = 8192;
+    static const int ErrorBackoff = 50;   // millisec, wait after WSAPoll fails
+
+    IoLoop();
+    IoLoop(const IoLoop& loop) = delete;
+    IoLoop& operator=(const IoLoop& loop) = delete;
+    ~IoLoop();
+
+    void add(Socket&& socket, std::unique_ptr<ConnectionHandler> pHandler);
+    void wake();
+    bool validState() const { return wakeRecv_ != INVALID_SOCKET; }
+    void run(std::atomic<bool>& stop);
+    size_t connections();
+  private:
+    struct Connection
+    {
+      Socket socket;
+      std::unique_ptr<ConnectionHandler> pHandler;
+    };
+    bool service(Connection& conn, Socket::byte* buffer);
+    void drainWake();
+
+    ::SOCKET wakeRecv_ = INVALID_SOCKET;
+    ::SOCKET wakeSend_ = INVALID_SOCKET;
+    std::mutex mtx_;
+    std::vector<Connection> added_;
+    std::vector<Connection> conns_;
+    std::atomic<size_t> count_{ 0 };
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   // SocketListener class
   // - listens for incoming connections
-  // - each connection is handled on its own thread
+  // - each connection is handled on its own thread, or by an IoLoop
 
   class SocketListener : public Socket
   {
@@ -158,16 +270,23 @@ namespace Sockets
     SocketListener& operator=(SocketListener&& s);
     virtual ~SocketListener();
 
+    using HandlerFactory = std::function<std::unique_ptr<ConnectionHandler>()>;
+
     template<typename CallObj>
     bool start(CallObj& co);
+    bool startPolled(HandlerFactory factory, size_t numIoThreads = 2);
     void stop();
   private:
     bool bind();
     bool listen();
     Socket accept();
+    void joinPolled();
     std::atomic<bool> stop_ = false;
     size_t port_;
     bool acceptFailed_ = false;
+    std::vector<std::unique_ptr<IoLoop>> loops_;
+    std::vector<std::thread> ioThreads_;
+    std::thread listenThread_;
   };
 
   //----< SocketListener start function runs listener on its own thread >------
@@ -194,7 +313,7 @@ namespace Sockets
     std::thread ListenThread(
       [&]()
     {
-      StaticLogger<1>::write("\n  -- server waiting for connection");
+      LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- server waiting for connection");
 
       while (!acceptFailed_)
       {
@@ -207,7 +326,7 @@ namespace Sockets
         if (!clientSocket.validState()) {
           continue;
         }
-        StaticLogger<1>::write("\n  -- server accepted connection");
+        LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- server accepted connection");
 
         // start thread to handle client request
 
@@ -215,7 +334,7 @@ namespace Sockets
         std::thread clientThread(co, std::move(clientSocket));
         clientThread.detach();  // detach - listener won't access thread again
       }
-      StaticLogger<1>::write("\n  -- Listen thread stopping");
+      LOG_WRITE(StaticLogger<1>, Logger::debug, "\n  -- Listen thread stopping");
     }
     );
     ListenThread.detach();
@@ -0,0 +1,345 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// BinaryCodec.h - compact binary encoding of DbElements               //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides the binary encoding used by WriteAheadLog and
+* by Persist's binary snapshots:
+* - appendVarint and appendString write unsigned numbers in 7 bit
+*   groups and strings as a varint length followed by their bytes.
+* - readVarint(std::istream&) reads a varint from a stream.
+* - Writer appends values to a std::string.  Reader reads them back
+*   from a range of bytes, throwing if the range ends before a value
+*   does.
+* - sharedString writes strings that repeat, like names, categories,
+*   and child keys.  A Writer made with shareStrings writes each one
+*   once, then refers to it by number.  Its Reader must also share
+*   strings, and read every value the Writer wrote, in order, since the
+*   numbering carries from one record to the next.
+* - a Reader made with a StringTable reads a shared string by number
+*   from the table, so records can be read in any order.  Persist's
+*   indexed snapshots write their Writer's strings as that table.
+* - crc32 checksums a range of bytes, and continues a checksum, so
+*   readers can detect records that were only partly written.
+* - appendElement and readElement encode a DbElement<P>.  They call
+*   the payload's hooks:
+*   - void serialize(Binary::Writer& out) const;
+*   - static P deserialize(Binary::Reader& in);
+*
+* Required Files:
+* ---------------
+* BinaryCodec.h, DbCore.h, Definitions.h
+* DateTime.h, DateTime.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 17th October 2026
+* - added StringTable, fixed 64 bit numbers, and Writer's string numbers
+* ver 1.1 : 17th October 2026
+* - added Writer and shared strings, crc32 continues a checksum
+* ver 1.0 : 17th October 2026
+* - first release
+*/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <istream>
+#include <exception>
+#include "DbCore.h"
+
+namespace NoSqlDb
+{
+  namespace Binary
+  {
+    //----< append number in 7 bit groups, low group first >-----------
+
+    inline void appendVarint(std::string& out, uint64_t value)
+    {
+      while (value >= 0x80)
+      {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+      }
+      out.push_back(static_cast<char>(value));
+    }
+    //----< append length, then bytes >--------------------------------
+
+    inline void appendString(std::string& out, const std::string& str)
+    {
+      appendVarint(out, str.size());
+      out.append(str);
+    }
+    //----< append 32 bit number, low byte first >---------------------
+
+    inline void appendFixed32(std::string& out, uint32_t value)
+    {
+      for (size_t i = 0; i < 4; ++i)
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+    //----< read 32 bit number written by appendFixed32 >--------------
+
+    inline uint32_t readFixed32(const char* pData)
+    {
+      uint32_t value = 0;
+      for (size_t i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(pData[i])) << (8 * i);
+      return value;
+    }
+    //----< append 64 bit number, low byte first >---------------------
+
+    inline void appendFixed64(std::string& out, uint64_t value)
+    {
+      appendFixed32(out, static_cast<uint32_t>(value));
+      appendFixed32(out, static_cast<uint32_t>(value >> 32));
+    }
+    //----< read 64 bit number written by appendFixed64 >--------------
+
+    inline uint64_t readFixed64(const char* pData)
+    {
+      return readFixed32(pData) | (static_cast<uint64_t>(readFixed32(pData + 4)) << 32);
+    }
+    //----< read number written by appendVarint from a stream >--------
+
+    inline uint64_t readVarint(std::istream& in)
+    {
+      uint64_t value = 0;
+      for (size_t shift = 0; shift < 64; shift += 7)
+      {
+        int byte = in.get();
+        if (byte == std::char_traits<char>::eof())
+          throw std::exception("binary stream truncated");
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          return value;
+      }
+      throw std::exception("binary varint too long");
+    }
+    //----< CRC-32 of size bytes at pData, continuing from crc >-------
+
+    inline uint32_t crc32(const char* pData, size_t size, uint32_t crc = 0)
+    {
+      static const struct Table
+      {
+        uint32_t entries[256];
+        Table()
+        {
+          for (uint32_t i = 0; i < 256; ++i)
+          {
+            uint32_t crc = i;
+            for (size_t bit = 0; bit < 8; ++bit)
+              crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+            entries[i] = crc;
+          }
+        }
+      } table;
+      crc ^= 0xffffffff;
+      for (size_t i = 0; i < size; ++i)
+        crc = table.entries[(crc ^ static_cast<unsigned char>(pData[i])) & 0xff] ^ (crc >> 8);
+      return crc ^ 0xffffffff;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Writer class
+    // - appends values to a string it does not own
+
+    class Writer
+    {
+    public:
+      explicit Writer(std::string& out, bool shareStrings = false) : pOut_(&out), share_(shareStrings) {}
+
+      void writeVarint(uint64_t value) { appendVarint(*pOut_, value); }
+      void writeString(const std::string& str) { appendString(*pOut_, str); }
+      void writeByte(char byte) { pOut_->push_back(byte); }
+      void writeSharedString(const std::string& str);
+      size_t sharedNumber(const std::string& str);
+      size_t sharedCount() { return order_.size(); }
+      const std::string& sharedString(size_t number) { return *order_[number - 1]; }
+      std::string& out() { return *pOut_; }
+    private:
+      std::string* pOut_;
+      bool share_;
+      std::unordered_map<std::string, size_t> table_;
+      std::vector<const std::string*> order_;
+    };
+    //----< write string, or its number if already written >-----------
+    /*
+    *  - 0 is followed by a new string, n refers to the nth new string
+    */
+    inline void Writer::writeSharedString(const std::string& str)
+    {
+      if (!share_)
+      {
+        writeString(str);
+        return;
+      }
+      auto iter = table_.find(str);
+      if (iter != table_.end())
+      {
+        writeVarint(iter->second);
+        return;
+      }
+      auto added = table_.emplace(str, table_.size() + 1);
+      order_.push_back(&added.first->first);
+      writeVarint(0);
+      writeString(str);
+    }
+    //----< number of a shared string already written, or 0 >----------
+
+    inline size_t Writer::sharedNumber(const std::string& str)
+    {
+      auto iter = table_.find(str);
+      return iter == table_.end() ? 0 : iter->second;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // StringTable struct
+    // - shared strings, numbered from 1, each pointing at a string
+    //   written by appendString in a range of bytes ending at pEnd
+
+    struct StringTable
+    {
+      std::vector<const char*> strings;
+      const char* pEnd = nullptr;
+      std::string get(uint64_t number) const;
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // Reader class
+    // - reads values from a range of bytes it does not own
+
+    class Reader
+    {
+    public:
+      Reader(const char* pBegin, const char* pEnd, bool shareStrings = false)
+        : pNext_(pBegin), pEnd_(pEnd), share_(shareStrings) {}
+      Reader(const char* pBegin, const char* pEnd, const StringTable& table)
+        : pNext_(pBegin), pEnd_(pEnd), share_(true), pTable_(&table) {}
+
+      uint64_t readVarint();
+      std::string readString();
+      void skipString();
+      std::string readSharedString();
+      char readByte();
+      bool done() { return pNext_ == pEnd_; }
+      const char* next() { return pNext_; }
+      void range(const char* pBegin, const char* pEnd) { pNext_ = pBegin; pEnd_ = pEnd; }
+    private:
+      const char* pNext_;
+      const char* pEnd_;
+      bool share_;
+      const StringTable* pTable_ = nullptr;
+      std::vector<std::string> table_;
+    };
+    //----< read number written by appendVarint >----------------------
+
+    inline uint64_t Reader::readVarint()
+    {
+      uint64_t value = 0;
+      for (size_t shift = 0; shift < 64; shift += 7)
+      {
+        unsigned char byte = static_cast<unsigned char>(readByte());
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          return value;
+      }
+      throw std::exception("binary varint too long");
+    }
+    //----< read string written by appendString >----------------------
+
+    inline std::string Reader::readString()
+    {
+      uint64_t size = readVarint();
+      if (size > static_cast<uint64_t>(pEnd_ - pNext_))
+        throw std::exception("binary string truncated");
+      std::string str(pNext_, static_cast<size_t>(size));
+      pNext_ += size;
+      return str;
+    }
+    //----< step over string written by appendString >-----------------
+
+    inline void Reader::skipString()
+    {
+      uint64_t size = readVarint();
+      if (size > static_cast<uint64_t>(pEnd_ - pNext_))
+        throw std::exception("binary string truncated");
+      pNext_ += size;
+    }
+    //----< read string written by writeSharedString >-----------------
+
+    inline std::string Reader::readSharedString()
+    {
+      if (!share_)
+        return readString();
+      uint64_t number = readVarint();
+      if (pTable_ != nullptr)
+        return number == 0 ? readString() : pTable_->get(number);
+      if (number == 0)
+      {
+        table_.push_back(readString());
+        return table_.back();
+      }
+      if (number > table_.size())
+        throw std::exception("binary shared string not defined");
+      return table_[static_cast<size_t>(number - 1)];
+    }
+    //----< read one byte >--------------------------------------------
+
+    inline char Reader::readByte()
+    {
+      if (pNext_ == pEnd_)
+        throw std::exception("binary record truncated");
+      return *pNext_++;
+    }
+    //----< read numbered string from the table >----------------------
+
+    inline std::string StringTable::get(uint64_t number) const
+    {
+      if (number == 0 || number > strings.size())
+        throw std::exception("binary shared string not defined");
+      Reader in(strings[static_cast<size_t>(number - 1)], pEnd);
+      return in.readString();
+    }
+    //----< append name, description, time, children, and payload >----
+
+    template<typename P>
+    void appendElement(Writer& out, const DbElement<P>& elem)
+    {
+      out.writeSharedString(elem.name());
+      out.writeString(elem.descrip());
+      DateTime dateTime = elem.dateTime();
+      out.writeVarint(static_cast<uint64_t>(dateTime.timepoint().time_since_epoch().count()));
+      Children children = elem.children();
+      out.writeVarint(children.size());
+      for (auto& child : children)
+        out.writeSharedString(child);
+      elem.payLoad().serialize(out);
+    }
+    //----< read element written by appendElement >--------------------
+
+    template<typename P>
+    DbElement<P> readElement(Reader& in)
+    {
+      DbElement<P> elem;
+      elem.name(in.readSharedString());
+      elem.descrip(in.readString());
+      DateTime::Duration sinceEpoch(static_cast<DateTime::Duration::rep>(in.readVarint()));
+      elem.dateTime(DateTime(DateTime::TimePoint(sinceEpoch)));
+      uint64_t numChildren = in.readVarint();
+      for (uint64_t i = 0; i < numChildren; ++i)
+        elem.children().push_back(in.readSharedString());
+      elem.payLoad(P::deserialize(in));
+      return elem;
+    }
+  }
+}
@@ -32,6 +32,11 @@
 *
 * Maintenance History:
 * --------------------
+*  ver 2.1 : 17th October 2026
+*  - parent index checked when adding and removing child keys
+*  - added test of concurrent VersionedDb readers and writers
+*  - parent index checked for child keys added through a kept reference
+*  - versions checked to share records that no writer changed
 *  ver 2.0 : 27th April 2018
 *  - second release
 * ver 1.3 : 17 Feb 2018
@@ -48,10 +53,12 @@
 #include <iostream>
 #include <iomanip>
 #include <functional>
+#include <thread>
 
 #ifdef TEST_DBCORE
 
 #include "DbCore.h"
+#include "VersionedDb.h"
 #include "../Utilities/StringUtilities/StringUtilities.h"
 #include "../Utilities/TestUtilities/TestUtilities.h"
 
@@ -200,6 +207,8 @@ bool testR5()
   Utilities::putline();
   if (!db["Fawcett"].containsChildKey(testKey))
     return false;
+  if (db.parents(testKey) != Parents{ "Fawcett" })
+    return false;
 
   Utilities::title("removing " + testKey + "child relationship from db[\"Fawcett\"]");
   db["Fawcett"].removeChildKey(testKey);
@@ -207,6 +216,18 @@ bool testR5()
   showDb(db);
   if (db["fawcett"].containsChildKey(testKey))
     return false;
+  if (db.parents(testKey).size() > 0)
+    return false;
+  Utilities::putline();
+
+  Utilities::title("adding " + testKey + " through a reference kept across an index lookup");
+  DbElement<std::string>& kept = db["Fawcett"];
+  db.parents(testKey);
+  kept.addChildKey(testKey);
+  if (db.parents(testKey) != Parents{ "Fawcett" })
+    return false;
+  kept.removeChildKey(testKey);
+  db.release();
   Utilities::putline();
 
   testKey = "Prashar";
@@ -222,6 +243,72 @@ bool testR5()
   Keys keys = db.parents(testKey);
   return 0 == keys.size();
 }
+//----< test concurrent readers and writers >--------------------------
+
+bool testVersions()
+{
+  Utilities::title("Demonstrating VersionedDb - readers use snapshots, writers lock keys");
+
+  VersionedDb<std::string> vdb;
+  VersionedDb<std::string>::Transaction trans = vdb.begin(Keys{ "Fawcett", "Salman" });
+  DbElement<std::string> elem;
+  elem.name("Jim");
+  elem.children().push_back("Salman");
+  trans.db().addRecord("Fawcett", elem);
+  elem.name("Ammar");
+  elem.children().clear();
+  trans.db().addRecord("Salman", elem);
+  trans.commit();
+  VersionedDb<std::string>::Snapshot before = vdb.read();
+
+  const size_t numWriters = 4;
+  const size_t numWrites = 25;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < numWriters; ++i)
+  {
+    threads.push_back(std::thread([&vdb, i]() {
+      Key writer = "writer" + std::to_string(i);
+      for (size_t j = 0; j < numWrites; ++j)
+      {
+        VersionedDb<std::string>::Transaction trans = vdb.begin(Keys{ writer });
+        DbElement<std::string> elem;
+        elem.name(writer);
+        trans.db().addRecord(writer + "." + std::to_string(j), elem);
+        trans.commit();
+      }
+    }));
+  }
+  bool readsOk = true;
+  threads.push_back(std::thread([&vdb, &readsOk]() {
+    for (size_t j = 0; j < 100; ++j)
+    {
+      VersionedDb<std::string>::Snapshot snap = vdb.read();
+      if (snap->parents("Salman") != Parents{ "Fawcett" })
+        readsOk = false;
+    }
+  }));
+  for (auto& thrd : threads)
+    thrd.join();
+
+  VersionedDb<std::string>::Snapshot after = vdb.read();
+  std::cout << "\n  " << vdb.version() << " versions committed, latest has "
+    << after->size() << " records";
+  if (!readsOk || after->size() != 2 + numWriters * numWrites)
+    return false;
+  bool shared = &before->find("Fawcett")->second == &after->find("Fawcett")->second;
+  std::cout << "\n  versions share records no writer changed: " << (shared ? "yes" : "no");
+  if (!shared)
+    return false;
+
+  Utilities::title("removing \"Salman\" leaves earlier snapshot unchanged");
+  vdb.removeRecord("Salman");
+  after = vdb.read();
+  showElem(after->find("Fawcett")->second);
+  Utilities::putline();
+  if (after->contains("Salman") || after->find("Fawcett")->second.children().size() > 0)
+    return false;
+  return before->size() == 2 && before->find("Fawcett")->second.children().size() == 1;
+}
 //----< test stub >----------------------------------------------------
 
 using namespace Utilities;
@@ -241,6 +328,7 @@ int main()
   TestExecutive::TestStr ts3b{ testR3b, "Create DbCore<std::string>" };
   TestExecutive::TestStr ts4{ testR4, "and and remove records" };
   TestExecutive::TestStr ts5{ testR5, "and and remove child relationships" };
+  TestExecutive::TestStr ts6{ testVersions, "concurrent readers and writers" };
 
   // register test structures with TestExecutive instance, ex
 
@@ -250,6 +338,7 @@ int main()
   ex.registerTest(ts3b);
   ex.registerTest(ts4);
   ex.registerTest(ts5);
+  ex.registerTest(ts6);
 
   // run tests
 
@@ -20,6 +20,26 @@
 * - DbElement provides the value part of our key-value database.
 *   It contains fields for name, description, date, child collection
 *   and a payload field of the template type. 
+* - RecordSource is implemented by stores that hold encoded records,
+*   like MappedSnapshot (see Persist).  A DbElement made by lazy()
+*   holds only its children and the record's offset in its source,
+*   and decodes its other fields the first time any of them is used.
+*   Copies of a lazy element share its decoded fields, so a record is
+*   decoded once however many db versions hold it.  Changing a field
+*   gives the element its own copy of the fields.
+* DbCore can optionally maintain secondary indexes on name, category,
+* status, and dateTime (see DbIndex.h), turned on with useIndexes(true).
+* They are off by default.  Building them reads every record's fields,
+* so a db of lazily decoded records, like the repository's, leaves them
+* off.
+* It always maintains a reverse index from child keys to parent keys,
+* so parents(key) and removeRecord(key) do not scan the whole db.
+* Records and indexes are held in PersistentMaps (see PersistentMap.h),
+* so copying a DbCore is O(1) and a copy shares every record it doesn't
+* change.  Records are kept, and iterated, in key order.
+* DbCore is not synchronized.  VersionedDb (see VersionedDb.h) shares
+* refreshed, read-only DbCore snapshots between threads and uses the
+* change tracking provided here to merge concurrent writers' changes.
 * The package also provides functions for displaying:
 * - set of all database keys
 * - database elements
@@ -28,11 +48,30 @@
 * Required Files:
 * ---------------
 * DbCore.h, DbCore.cpp
+* DbIndex.h, PersistentMap.h
 * DateTime.h, DateTime.cpp
 * Utilities.h, Utilities.cpp
 *
 * Maintenance History:
 * --------------------
+*  ver 2.4 : 17th October 2026
+*  - records, parent index, and secondary indexes are PersistentMaps,
+*    so copies share records and a change copies only what it touches
+*  - iterators are const, bucket access replaced by nth(rank)
+*  - added lower_bound, and roots for keys of records with no parent
+*  - copies of a lazy DbElement share one decoded body, added decodedCopy
+*  ver 2.3 : 17th October 2026
+*  - added putRecord, and clear and load for loading many records, so
+*    loaders no longer change records through dbStore()
+*  - records reached through operator[] are checked at each index lookup
+*    until release(), so edits through a kept reference are indexed
+*  ver 2.2 : 17th October 2026
+*  - added RecordSource and lazily decoded DbElements
+*  ver 2.1 : 17th October 2026
+*  - added optional, incrementally maintained secondary indexes
+*  - added reverse child to parent index used by parents and removeRecord
+*  - added bucket iterators for partitioned scans
+*  - added change tracking and refresh, used by VersionedDb
 *  ver 2.0 : 27th April 2018
 *  - second release
 * ver 1.3 : 17 Feb 2018
@@ -46,16 +85,37 @@
 * - first release
 */
 
-#include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include "Definitions.h"
+#include "DbIndex.h"
+#include "PersistentMap.h"
 #include "../DateTime/DateTime.h"
 
 namespace NoSqlDb
 {
+  template<typename P>
+  class DbElement;
+
+  /////////////////////////////////////////////////////////////////////
+  // RecordSource class
+  // - store of encoded records that lazy DbElements decode from
+
+  template<typename P>
+  class RecordSource
+  {
+  public:
+    virtual ~RecordSource() {}
+    virtual DbElement<P> decode(size_t offset) const = 0;
+  };
+
   /////////////////////////////////////////////////////////////////////
   // DbElement class
   // - provides the value part of a NoSql key-value database
@@ -67,40 +127,125 @@ namespace NoSqlDb
 
     DbElement() {}
 
+    static DbElement<P> lazy(std::shared_ptr<const RecordSource<P>> pSource, size_t offset, const Children& children);
+    bool loaded() const { return !pLazy_ || pLazy_->isLoaded.load(std::memory_order_acquire); }
+    DbElement<P> decodedCopy() const;
+
     // methods to get and set DbElement fields
 
-    std::string& name() { return name_; }
-    std::string name() const { return name_; }
-    void name(const std::string& name) { name_ = name; }
+    std::string& name() { return ownBody().name; }
+    std::string name() const { return body().name; }
+    void name(const std::string& name) { ownBody().name = name; }
 
-    std::string& descrip() { return descrip_; }
-    std::string descrip() const { return descrip_; }
-    void descrip(const std::string& name) { descrip_ = name; }
+    std::string& descrip() { return ownBody().descrip; }
+    std::string descrip() const { return body().descrip; }
+    void descrip(const std::string& name) { ownBody().descrip = name; }
     
-    DateTime& dateTime() { return dateTime_; }
-    DateTime dateTime() const { return dateTime_; }
-    void dateTime(const DateTime& dateTime) { dateTime_ = dateTime; }
+    DateTime& dateTime() { return ownBody().dateTime; }
+    DateTime dateTime() const { return body().dateTime; }
+    void dateTime(const DateTime& dateTime) { ownBody().dateTime = dateTime; }
 
     Children& children() { return children_; }
     Children children() const { return children_; }
     void children(const Children& children) { children_ = children; }
    
+    // changes made through a reference from DbCore<P>::operator[] are seen
+    // by the db's indexes until the db's release() is called, see DbCore
+
     bool containsChildKey(const Key& key);
     bool addChildKey(const Key& key);
     bool removeChildKey(const Key& key);
     void clearChildKeys() { children_.clear(); }
 
-    P& payLoad() { return payLoad_; }
-    P payLoad() const { return payLoad_; }
-    void payLoad(const P& payLoad) { payLoad_ = payLoad; }
+    P& payLoad() { return ownBody().payLoad; }
+    P payLoad() const { return body().payLoad; }
+    void payLoad(const P& payLoad) { ownBody().payLoad = payLoad; }
 
   private:
-    std::string name_;
-    std::string descrip_;
-    DateTime dateTime_;
+    struct Body
+    {
+      std::string name;
+      std::string descrip;
+      DateTime dateTime;
+      P payLoad;
+    };
+    struct Lazy
+    {
+      Lazy(std::shared_ptr<const RecordSource<P>> pSrc, size_t off)
+        : pSource(pSrc), offset(off), isLoaded(false) {}
+      std::shared_ptr<const RecordSource<P>> pSource;
+      size_t offset;
+      std::once_flag once;
+      std::atomic<bool> isLoaded;
+      Body body;
+    };
+    const Body& body() const;
+    Body& ownBody();
+
+    Body body_;
     Children children_;
-    P payLoad_;
+    std::shared_ptr<Lazy> pLazy_;
   };
+  //----< make element whose body is decoded from pSource on use >-----
+  /*
+  *  - copies share the Lazy, so whichever copy is used first decodes
+  *    the body for all of them
+  */
+  template<typename P>
+  DbElement<P> DbElement<P>::lazy(std::shared_ptr<const RecordSource<P>> pSource, size_t offset, const Children& children)
+  {
+    DbElement<P> elem;
+    elem.children_ = children;
+    elem.pLazy_ = std::make_shared<Lazy>(pSource, offset);
+    return elem;
+  }
+  //----< decoded element, without keeping the decoded body in this >--
+  /*
+  *  - lets a whole db be saved or exported without every record it
+  *    holds staying decoded
+  */
+  template<typename P>
+  DbElement<P> DbElement<P>::decodedCopy() const
+  {
+    if (loaded())
+      return *this;
+    DbElement<P> elem = pLazy_->pSource->decode(pLazy_->offset);
+    elem.children_ = children_;
+    return elem;
+  }
+  //----< fields, decoded into the shared Lazy on first use >----------
+  /*
+  *  - a snapshot shared by many readers is decoded once, by the first
+  *  - the decoded element's children are ignored, this one's are kept
+  */
+  template<typename P>
+  const typename DbElement<P>::Body& DbElement<P>::body() const
+  {
+    if (!pLazy_)
+      return body_;
+    Lazy& lazy = *pLazy_;
+    if (!lazy.isLoaded.load(std::memory_order_acquire))
+    {
+      std::call_once(lazy.once, [&lazy]() {
+        DbElement<P> elem = lazy.pSource->decode(lazy.offset);
+        lazy.body = std::move(elem.body_);
+        lazy.isLoaded.store(true, std::memory_order_release);
+      });
+    }
+    return lazy.body;
+  }
+  //----< fields this element may change, copied from Lazy if shared >-
+
+  template<typename P>
+  typename DbElement<P>::Body& DbElement<P>::ownBody()
+  {
+    if (pLazy_)
+    {
+      body_ = body();
+      pLazy_.reset();
+    }
+    return body_;
+  }
   //----< does children collection contain key? >----------------------
 
   template<typename P>
@@ -169,8 +314,8 @@ namespace NoSqlDb
   class DbCore
   {
   public:
-    using DbStore = std::unordered_map<Key,DbElement<P>>;
-    using iterator = typename DbStore::iterator;
+    using DbStore = PersistentMap<Key,DbElement<P>>;
+    using iterator = typename DbStore::const_iterator;
 
     static void identify(std::ostream& out = std::cout);
 
@@ -182,20 +327,71 @@ namespace NoSqlDb
     void throwOnIndexNotFound(bool doThrow) { doThrow_ = doThrow; }
     DbElement<P>& operator[](const Key& key);
     DbElement<P> operator[](const Key& key) const;
-    typename iterator begin() { return dbStore_.begin(); }
-    typename iterator end() { return dbStore_.end(); }
+    typename iterator begin() const { return dbStore_.begin(); }
+    typename iterator end() const { return dbStore_.end(); }
+    iterator find(const Key& key) const { return dbStore_.find(key); }
+    iterator lower_bound(const Key& key) const { return dbStore_.lower_bound(key); }
+
+    // rank access, used to partition the db for parallel queries
+
+    iterator nth(size_t rank) const { return dbStore_.nth(rank); }
 
     // methods to get and set the private database hash-map storage
 
-    DbStore& dbStore() { return dbStore_; }
     DbStore dbStore() const { return dbStore_; }
-    void dbStore(const DbStore& dbStore) { dbStore_ = dbStore; }
+    void dbStore(const DbStore& dbStore);
     bool addRecord(const Key& key, const DbElement<P>& elem);
+    void putRecord(const Key& key, const DbElement<P>& elem);
     bool removeRecord(const Key& key);
     Parents parents(const Key& key);
+    Keys roots();
+
+    // methods to load many records at once
+    // - load adds or replaces a record without reindexing it, the indexes
+    //   are rebuilt once, by the next index lookup after loading
+
+    void clear();
+    void load(const Key& key, const DbElement<P>& elem);
+
+    // methods to manage parent and secondary indexes
+    // - records changed through addRecord, putRecord, or removeRecord
+    //   are reindexed before the next index lookup
+    // - a record reached through operator[] may be changed through the
+    //   reference it returns at any time, so it is checked, and
+    //   reindexed if changed, at every index lookup until release()
+    // - copies of the db share records, so a reference returned by
+    //   operator[] must not be used once the db has been copied
+
+    void useIndexes(bool doIndex);
+    bool usingIndexes() { return doIndex_; }
+    DbIndex<P>& indexes();
+    void reindex(const Key& key);
+    void refresh() { refreshIndexes(); }
+    void release() { refreshIndexes(); referenced_.clear(); }
+
+    // keys of records changed through operator[], addRecord, putRecord,
+    // removeRecord, clear, load, or reindex since tracking was turned on,
+    // including records read with operator[]
+
+    void trackChanges(bool track);
+    const std::unordered_set<Key>& changes() { return changes_; }
   private:
+    void refreshIndexes();
+    void update(const Key& key);
+    void changed(const Key& key);
+    void linkChildren(const Key& parent, const Children& children);
+    void unlinkChildren(const Key& parent);
     DbStore dbStore_;
     bool doThrow_ = false;
+    bool doIndex_ = false;
+    bool indexStale_ = false;
+    DbIndex<P> index_;
+    std::unordered_set<Key> dirtyKeys_;
+    std::unordered_set<Key> referenced_;
+    bool trackChanges_ = false;
+    std::unordered_set<Key> changes_;
+    PersistentMap<std::pair<Key, Key>, bool> parentIndex_;  // (child, parent)
+    PersistentMap<Key, Children> indexedChildren_;
   };
 
   /////////////////////////////////////////////////////////////////////
@@ -213,8 +409,7 @@ namespace NoSqlDb
   template<typename P>
   bool DbCore<P>::contains(const Key& key)
   {
-    iterator iter = dbStore_.find(key);
-    return iter != dbStore_.end();
+    return dbStore_.contains(key);
   }
   //----< returns current key set for db >-----------------------------
 
@@ -222,10 +417,10 @@ namespace NoSqlDb
   typename Keys DbCore<P>::keys()
   {
     Keys dbKeys;
-    DbStore& dbs = dbStore();
+    const DbStore& dbs = dbStore_;
     size_t size = dbs.size();
     dbKeys.reserve(size);
-    for (auto item : dbs)
+    for (auto& item : dbs)
     {
       dbKeys.push_back(item.first);
     }
@@ -254,13 +449,10 @@ namespace NoSqlDb
   template<typename P>
   DbElement<P>& DbCore<P>::operator[](const Key& key)
   {
-    if (!contains(key))
-    {
-      if (doThrow_)
-        throw(std::exception("key does not exist in db"));
-      else
-        return (dbStore_[key] = DbElement<P>());
-    }
+    if (doThrow_ && !contains(key))
+      throw(std::exception("key does not exist in db"));
+    referenced_.insert(key);  // caller may modify the element, now or later
+    changed(key);
     return dbStore_[key];
   }
   //----< extracts value from db with key >----------------------------
@@ -270,47 +462,261 @@ namespace NoSqlDb
   template<typename P>
   DbElement<P> DbCore<P>::operator[](const Key& key) const
   {
-    if (!contains(key))
+    iterator iter = dbStore_.find(key);
+    if (iter == dbStore_.end())
     {
       throw(std::exception("key does not exist in db"));
     }
-    return dbStore_[key];
+    return iter->second;
   }
   //----< adds database record if key does not exist >-----------------
 
   template<typename P>
   bool DbCore<P>::addRecord(const Key& key, const DbElement<P>& elem)
   {
-    if (contains(key))
+    if (!dbStore_.insert(key, elem))
       return false;
-    dbStore_[key] = elem;
+    changed(key);
+    if (indexStale_)
+      return true;
+    linkChildren(key, elem.children());
+    if (doIndex_)
+      dirtyKeys_.insert(key);
     return true;
   }
+  //----< adds database record, or replaces the record with key >------
+
+  template<typename P>
+  void DbCore<P>::putRecord(const Key& key, const DbElement<P>& elem)
+  {
+    dbStore_.insert(key, elem);
+    dirtyKeys_.insert(key);
+    changed(key);
+  }
   //----< removes database record if key exists >----------------------
 
+  /*
+  *  - also removes key from the children of every parent record
+  */
   template<typename P>
   bool DbCore<P>::removeRecord(const Key& key)
   {
-    size_t numErased = dbStore_.erase(key);
     Parents parents = this->parents(key);
-    for (auto dbKey : parents)
+    size_t numErased = dbStore_.erase(key);
+    dirtyKeys_.erase(key);
+    referenced_.erase(key);
+    changed(key);
+    unlinkChildren(key);
+    if (doIndex_)
+      index_.remove(key);
+    for (auto& dbKey : parents)
     {
-      dbStore_[dbKey].removeChildKey(key);
+      DbElement<P>* pParent = dbStore_.modify(dbKey);
+      if (pParent != nullptr)
+      {
+        pParent->removeChildKey(key);
+        changed(dbKey);
+      }
+      Children* pChildren = indexedChildren_.modify(dbKey);
+      if (pChildren != nullptr)
+        pChildren->erase(std::remove(pChildren->begin(), pChildren->end(), key), pChildren->end());
+      parentIndex_.erase(std::make_pair(key, dbKey));
     }
     return numErased > 0;
   }
   //----< find all parents of record index by key >--------------------
-
+  /*
+  *  - uses the reverse index, so cost is proportional to number of parents
+  */
   template<typename P>
   Parents DbCore<P>::parents(const Key& key)
   {
+    refreshIndexes();
     Parents parents;
-    for (auto item : dbStore_)
+    auto iter = parentIndex_.lower_bound(std::make_pair(key, Key()));
+    for (; iter != parentIndex_.end() && iter->first.first == key; ++iter)
+      parents.push_back(iter->first.second);
+    return parents;
+  }
+  //----< keys of records that are not the child of any record >------
+  /*
+  *  - records and the parent index are both in key order, so one merge
+  *    of the two finds every key without a parent
+  */
+  template<typename P>
+  Keys DbCore<P>::roots()
+  {
+    refreshIndexes();
+    Keys roots;
+    auto child = parentIndex_.begin();
+    for (auto& item : dbStore_)
     {
-      if (item.second.containsChildKey(key))
-        parents.push_back(item.first);
+      while (child != parentIndex_.end() && child->first.first < item.first)
+        ++child;
+      if (child == parentIndex_.end() || child->first.first != item.first)
+        roots.push_back(item.first);
     }
-    return parents;
+    return roots;
+  }
+  //----< add parent to the reverse index entry of each child >--------
+
+  template<typename P>
+  void DbCore<P>::linkChildren(const Key& parent, const Children& children)
+  {
+    for (auto& child : children)
+      parentIndex_.insert(std::make_pair(child, parent), true);
+    indexedChildren_.insert(parent, children);
+  }
+  //----< remove parent from reverse index entries of its children >---
+
+  template<typename P>
+  void DbCore<P>::unlinkChildren(const Key& parent)
+  {
+    auto found = indexedChildren_.find(parent);
+    if (found == indexedChildren_.end())
+      return;
+    for (auto& child : found->second)
+      parentIndex_.erase(std::make_pair(child, parent));
+    indexedChildren_.erase(parent);
+  }
+  //----< replace db storage >-----------------------------------------
+
+  template<typename P>
+  void DbCore<P>::dbStore(const DbStore& dbStore)
+  {
+    dbStore_ = dbStore;
+    indexStale_ = true;
+  }
+  //----< remove all records >-----------------------------------------
+
+  template<typename P>
+  void DbCore<P>::clear()
+  {
+    if (trackChanges_)
+    {
+      for (auto& item : dbStore_)
+        changes_.insert(item.first);
+    }
+    dbStore_.clear();
+    index_.clear();
+    parentIndex_.clear();
+    indexedChildren_.clear();
+    dirtyKeys_.clear();
+    referenced_.clear();
+    indexStale_ = false;
+  }
+  //----< add or replace record, indexes are rebuilt on next use >-----
+  /*
+  *  - for loading many records, use putRecord to change a few
+  */
+  template<typename P>
+  void DbCore<P>::load(const Key& key, const DbElement<P>& elem)
+  {
+    dbStore_.insert(key, elem);
+    indexStale_ = true;
+    changed(key);
+  }
+  //----< turn secondary indexes on or off >---------------------------
+  /*
+  *  - indexes are built lazily on first use after turning them on
+  *  - the parent index is always maintained
+  */
+  template<typename P>
+  void DbCore<P>::useIndexes(bool doIndex)
+  {
+    doIndex_ = doIndex;
+    index_.clear();
+    if (doIndex)
+      indexStale_ = true;
+  }
+  //----< return up-to-date secondary indexes >------------------------
+
+  template<typename P>
+  DbIndex<P>& DbCore<P>::indexes()
+  {
+    refreshIndexes();
+    return index_;
+  }
+  //----< mark record as changed so it will be reindexed >-------------
+
+  template<typename P>
+  void DbCore<P>::reindex(const Key& key)
+  {
+    dirtyKeys_.insert(key);
+    changed(key);
+  }
+  //----< turn change tracking on or off, discarding tracked keys >----
+
+  template<typename P>
+  void DbCore<P>::trackChanges(bool track)
+  {
+    trackChanges_ = track;
+    changes_.clear();
+  }
+  //----< record key as changed, if tracking >-------------------------
+
+  template<typename P>
+  void DbCore<P>::changed(const Key& key)
+  {
+    if (trackChanges_)
+      changes_.insert(key);
+  }
+  //----< bring indexes up to date with changed records >--------------
+  /*
+  *  - writes nothing if indexes are current, so a refreshed db may be
+  *    read by many threads at once
+  *  - records reached through operator[] are checked every time, so
+  *    the cost grows with their number until release()
+  */
+  template<typename P>
+  void DbCore<P>::refreshIndexes()
+  {
+    if (indexStale_)
+    {
+      index_.clear();
+      parentIndex_.clear();
+      indexedChildren_.clear();
+      for (auto& item : dbStore_)
+      {
+        linkChildren(item.first, item.second.children());
+        if (doIndex_)
+          index_.insert(item.first, item.second);
+      }
+      indexStale_ = false;
+      dirtyKeys_.clear();
+      return;
+    }
+    if (!dirtyKeys_.empty())
+    {
+      for (auto& key : dirtyKeys_)
+        update(key);
+      dirtyKeys_.clear();
+    }
+    for (auto& key : referenced_)
+      update(key);
+  }
+  //----< reindex record with key, if its indexed values changed >-----
+
+  template<typename P>
+  void DbCore<P>::update(const Key& key)
+  {
+    iterator iter = dbStore_.find(key);
+    if (iter == dbStore_.end())
+    {
+      unlinkChildren(key);
+      if (doIndex_)
+        index_.remove(key);
+      return;
+    }
+    const Children& children = iter->second.children();
+    auto indexed = indexedChildren_.find(key);
+    if (indexed == indexedChildren_.end() || indexed->second != children)
+    {
+      unlinkChildren(key);
+      linkChildren(key, children);
+    }
+    if (doIndex_)
+      index_.insert(key, iter->second);
   }
 
   /////////////////////////////////////////////////////////////////////
@@ -0,0 +1,242 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// DbIndex.h - secondary indexes for NoSql database                    //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides two classes:
+* - IndexTraits<P> tells DbIndex how to extract categories and status
+*   from a payload.  The default has neither, so DbCore<std::string>
+*   only indexes name and dateTime.  Applications specialize it for
+*   their PayLoad, see PayLoad.h.
+* - DbIndex<P> holds secondary indexes on name, category, status, and
+*   dateTime that map each value to the set of db keys holding it.
+*   DbCore<P> keeps it up to date as records are added, edited, and
+*   removed, and Query<P> uses it to avoid scanning the whole db.
+*   Each index is a PersistentMap of (value, key) pairs, so copying a
+*   DbIndex is cheap and a copy shares all entries it doesn't change.
+*
+* Required Files:
+* ---------------
+* DbIndex.h, PersistentMap.h, Definitions.h
+* DateTime.h, DateTime.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 17th October 2026
+* - indexes are PersistentMaps of (value, key) pairs, so copies share
+*   their entries and a change copies only the entries it touches
+* ver 1.1 : 17th October 2026
+* - insert leaves a record's entries alone if its indexed values are
+*   unchanged
+* ver 1.0 : 17th October 2026
+* - first release
+*/
+
+#include <set>
+#include <string>
+#include <vector>
+#include <utility>
+#include "Definitions.h"
+#include "PersistentMap.h"
+#include "../DateTime/DateTime.h"
+
+namespace NoSqlDb
+{
+  template<typename P>
+  class DbElement;
+
+  /////////////////////////////////////////////////////////////////////
+  // IndexTraits class
+  // - extracts indexed payload fields, specialized by the application
+
+  template<typename P>
+  struct IndexTraits
+  {
+    static Keys categories(const P& payLoad) { return Keys(); }
+    static std::string status(const P& payLoad) { return ""; }
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // DbIndex class
+  // - maps name, category, status, and dateTime to sets of db keys
+  // - pairs are ordered by value, then key, so lookups return sorted keys
+
+  template<typename P>
+  class DbIndex
+  {
+  public:
+    using KeySet = std::set<Key>;
+    using StringIndex = PersistentMap<std::pair<std::string, Key>, bool>;
+    using TimeIndex = PersistentMap<std::pair<DateTime::TimePoint, Key>, bool>;
+
+    void insert(const Key& key, const DbElement<P>& elem);
+    void remove(const Key& key);
+    void clear();
+    size_t size() { return entries_.size(); }
+
+    Keys name(const std::string& name);
+    Keys namePrefix(const std::string& prefix);
+    Keys category(const std::string& category);
+    Keys status(const std::string& status);
+    Keys dateTime(DateTime lower, DateTime upper);
+
+  private:
+    struct Entry
+    {
+      std::string name;
+      Keys categories;
+      std::string status;
+      DateTime::TimePoint time;
+      bool operator==(const Entry& entry) const;
+    };
+    static Keys keysAt(const StringIndex& index, const std::string& value);
+    static Keys toKeys(const KeySet& keySet);
+
+    PersistentMap<Key, Entry> entries_;
+    StringIndex names_;
+    StringIndex categories_;
+    StringIndex status_;
+    TimeIndex times_;
+  };
+  //----< keys paired with value in index >---------------------------
+
+  template<typename P>
+  Keys DbIndex<P>::keysAt(const StringIndex& index, const std::string& value)
+  {
+    Keys keys;
+    StringIndex::iterator iter = index.lower_bound(std::make_pair(value, Key()));
+    for (; iter != index.end() && iter->first.first == value; ++iter)
+      keys.push_back(iter->first.second);
+    return keys;
+  }
+  //----< copy key set into Keys vector >------------------------------
+
+  template<typename P>
+  Keys DbIndex<P>::toKeys(const KeySet& keySet)
+  {
+    return Keys(keySet.begin(), keySet.end());
+  }
+  //----< do entries index the same values? >--------------------------
+
+  template<typename P>
+  bool DbIndex<P>::Entry::operator==(const Entry& entry) const
+  {
+    return name == entry.name && categories == entry.categories
+      && status == entry.status && time == entry.time;
+  }
+  //----< index record, replacing any previous entry for key >---------
+  /*
+  *  - writes nothing if key's entry already holds elem's values
+  */
+  template<typename P>
+  void DbIndex<P>::insert(const Key& key, const DbElement<P>& elem)
+  {
+    Entry entry;
+    entry.name = elem.name();
+    P payLoad = elem.payLoad();
+    entry.categories = IndexTraits<P>::categories(payLoad);
+    entry.status = IndexTraits<P>::status(payLoad);
+    entry.time = elem.dateTime().timepoint();
+    typename PersistentMap<Key, Entry>::iterator found = entries_.find(key);
+    if (found != entries_.end() && found->second == entry)
+      return;
+    remove(key);
+
+    names_.insert(std::make_pair(entry.name, key), true);
+    for (auto cat : entry.categories)
+      categories_.insert(std::make_pair(cat, key), true);
+    status_.insert(std::make_pair(entry.status, key), true);
+    times_.insert(std::make_pair(entry.time, key), true);
+    entries_.insert(key, entry);
+  }
+  //----< remove all index entries for key >---------------------------
+
+  template<typename P>
+  void DbIndex<P>::remove(const Key& key)
+  {
+    typename PersistentMap<Key, Entry>::iterator iter = entries_.find(key);
+    if (iter == entries_.end())
+      return;
+    const Entry& entry = iter->second;
+    names_.erase(std::make_pair(entry.name, key));
+    for (auto cat : entry.categories)
+      categories_.erase(std::make_pair(cat, key));
+    status_.erase(std::make_pair(entry.status, key));
+    times_.erase(std::make_pair(entry.time, key));
+    entries_.erase(key);
+  }
+  //----< drop all index entries >-------------------------------------
+
+  template<typename P>
+  void DbIndex<P>::clear()
+  {
+    entries_.clear();
+    names_.clear();
+    categories_.clear();
+    status_.clear();
+    times_.clear();
+  }
+  //----< keys of records with exactly this name >---------------------
+
+  template<typename P>
+  Keys DbIndex<P>::name(const std::string& name)
+  {
+    return keysAt(names_, name);
+  }
+  //----< keys of records whose name starts with prefix >--------------
+
+  template<typename P>
+  Keys DbIndex<P>::namePrefix(const std::string& prefix)
+  {
+    KeySet found;
+    StringIndex::iterator iter = names_.lower_bound(std::make_pair(prefix, Key()));
+    for (; iter != names_.end(); ++iter)
+    {
+      if (iter->first.first.compare(0, prefix.size(), prefix) != 0)
+        break;
+      found.insert(iter->first.second);
+    }
+    return toKeys(found);
+  }
+  //----< keys of records whose payload has category >-----------------
+
+  template<typename P>
+  Keys DbIndex<P>::category(const std::string& category)
+  {
+    return keysAt(categories_, category);
+  }
+  //----< keys of records whose payload has status >-------------------
+
+  template<typename P>
+  Keys DbIndex<P>::status(const std::string& status)
+  {
+    return keysAt(status_, status);
+  }
+  //----< keys of records with lower < dateTime < upper >--------------
+
+  template<typename P>
+  Keys DbIndex<P>::dateTime(DateTime lower, DateTime upper)
+  {
+    KeySet found;
+    if (!(lower < upper))
+      return Keys();
+    DateTime::TimePoint first = lower.timepoint();
+    DateTime::TimePoint last = upper.timepoint();
+    TimeIndex::iterator iter = times_.lower_bound(std::make_pair(first, Key()));
+    for (; iter != times_.end() && iter->first.first < last; ++iter)
+    {
+      if (first < iter->first.first)
+        found.insert(iter->first.second);
+    }
+    return toKeys(found);
+  }
+}
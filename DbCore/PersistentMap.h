@@ -0,0 +1,408 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// PersistentMap.h - ordered map whose copies share unchanged entries  //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides a single class, PersistentMap<K,V>, an ordered
+* map held in a treap of reference counted nodes:
+* - copying a map copies only its root pointer, so the copy shares all
+*   of its nodes and entries with the original
+* - changing a map copies the nodes on the path from the root to the
+*   changed entry, and the entry itself, only where they are shared
+*   with another copy, so a change costs O(log n) whatever the number
+*   of copies
+* - node priorities are drawn from a scrambled counter, so keys need
+*   only operator<, and the tree stays balanced whatever the key order
+* - nodes keep the size of their subtree, so nth(rank) finds an entry
+*   by position in O(log n)
+* Iterators are const.  Entries are changed with operator[], modify, or
+* insert, never through an iterator.  Like std::map iterators, they are
+* invalidated by changing the map they came from, but not by changing
+* a copy.
+*
+* Copies may be read by many threads at once, and each may be changed
+* by one thread at a time, since a change never writes to a node that
+* another copy can reach.
+*
+* Required Files:
+* ---------------
+* PersistentMap.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 17th October 2026
+* - first release
+*/
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <iterator>
+
+namespace NoSqlDb
+{
+  /////////////////////////////////////////////////////////////////////
+  // PersistentMap class
+  // - ordered map with O(1) copy, O(log n) find, insert, and erase
+
+  template<typename K, typename V>
+  class PersistentMap
+  {
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    class const_iterator;
+    using iterator = const_iterator;
+
+    size_t size() const { return sizeOf(root_); }
+    bool empty() const { return !root_; }
+    void clear() { root_.reset(); }
+
+    const_iterator begin() const;
+    const_iterator end() const { return const_iterator(); }
+    const_iterator find(const K& key) const;
+    const_iterator lower_bound(const K& key) const;
+    const_iterator nth(size_t rank) const;
+    bool contains(const K& key) const { return find(key) != end(); }
+
+    V& operator[](const K& key);
+    V* modify(const K& key);
+    bool insert(const K& key, const V& value);
+    size_t erase(const K& key);
+
+  private:
+    struct Node;
+    using Link = std::shared_ptr<Node>;
+    struct Node
+    {
+      Node(const K& key, const V& value) : pItem(std::make_shared<value_type>(key, value)), priority(nextPriority()) {}
+      std::shared_ptr<value_type> pItem;
+      size_t priority;
+      size_t size = 1;
+      Link left;
+      Link right;
+    };
+    static size_t nextPriority();
+    static size_t sizeOf(const Link& node) { return node ? node->size : 0; }
+    static void resize(Node& node) { node.size = 1 + sizeOf(node.left) + sizeOf(node.right); }
+    template<typename T>
+    static void own(std::shared_ptr<T>& pShared);
+    static V& put(Link& node, const K& key, const V& value, bool& added);
+    static bool remove(Link& node, const K& key);
+    static Link merge(Link left, Link right);
+    static void rotateLeft(Link& node);
+    static void rotateRight(Link& node);
+
+    Link root_;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // const_iterator class
+  // - in-order walk, holding the nodes still to be visited on a stack
+
+  template<typename K, typename V>
+  class PersistentMap<K, V>::const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename PersistentMap<K, V>::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    reference operator*() const { return *path_.back()->pItem; }
+    pointer operator->() const { return path_.back()->pItem.get(); }
+    const_iterator& operator++();
+    const_iterator operator++(int) { const_iterator prev = *this; ++*this; return prev; }
+    bool operator==(const const_iterator& iter) const;
+    bool operator!=(const const_iterator& iter) const { return !(*this == iter); }
+  private:
+    friend class PersistentMap<K, V>;
+    void pushLeft(const Node* pNode);
+    std::vector<const Node*> path_;
+  };
+  //----< move to next entry in key order >----------------------------
+
+  template<typename K, typename V>
+  typename PersistentMap<K, V>::const_iterator& PersistentMap<K, V>::const_iterator::operator++()
+  {
+    const Node* pNode = path_.back();
+    path_.pop_back();
+    pushLeft(pNode->right.get());
+    return *this;
+  }
+  //----< iterators are equal if both at end or at the same node >-----
+
+  template<typename K, typename V>
+  bool PersistentMap<K, V>::const_iterator::operator==(const const_iterator& iter) const
+  {
+    if (path_.empty() || iter.path_.empty())
+      return path_.empty() == iter.path_.empty();
+    return path_.back() == iter.path_.back();
+  }
+  //----< push pNode and its chain of left descendants >---------------
+
+  template<typename K, typename V>
+  void PersistentMap<K, V>::const_iterator::pushLeft(const Node* pNode)
+  {
+    for (; pNode != nullptr; pNode = pNode->left.get())
+      path_.push_back(pNode);
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // PersistentMap<K,V> methods
+
+  //----< iterator at smallest key >-----------------------------------
+
+  template<typename K, typename V>
+  typename PersistentMap<K, V>::const_iterator PersistentMap<K, V>::begin() const
+  {
+    const_iterator iter;
+    iter.pushLeft(root_.get());
+    return iter;
+  }
+  //----< iterator at key, or end() if key is not in map >-------------
+
+  template<typename K, typename V>
+  typename PersistentMap<K, V>::const_iterator PersistentMap<K, V>::find(const K& key) const
+  {
+    const_iterator iter = lower_bound(key);
+    if (iter == end() || key < iter->first)
+      return end();
+    return iter;
+  }
+  //----< iterator at first key not less than key >--------------------
+
+  template<typename K, typename V>
+  typename PersistentMap<K, V>::const_iterator PersistentMap<K, V>::lower_bound(const K& key) const
+  {
+    const_iterator iter;
+    const Node* pNode = root_.get();
+    while (pNode != nullptr)
+    {
+      if (pNode->pItem->first < key)
+      {
+        pNode = pNode->right.get();
+        continue;
+      }
+      iter.path_.push_back(pNode);
+      if (!(key < pNode->pItem->first))
+        break;
+      pNode = pNode->left.get();
+    }
+    return iter;
+  }
+  //----< iterator at rank'th smallest key, end() if rank >= size >---
+
+  template<typename K, typename V>
+  typename PersistentMap<K, V>::const_iterator PersistentMap<K, V>::nth(size_t rank) const
+  {
+    const_iterator iter;
+    const Node* pNode = root_.get();
+    while (pNode != nullptr)
+    {
+      size_t leftSize = sizeOf(pNode->left);
+      if (rank > leftSize)
+      {
+        rank -= leftSize + 1;
+        pNode = pNode->right.get();
+        continue;
+      }
+      iter.path_.push_back(pNode);
+      if (rank == leftSize)
+        return iter;
+      pNode = pNode->left.get();
+    }
+    return end();
+  }
+  //----< value at key, added with default value if key is not in map >
+
+  template<typename K, typename V>
+  V& PersistentMap<K, V>::operator[](const K& key)
+  {
+    V* pValue = modify(key);
+    if (pValue != nullptr)
+      return *pValue;
+    bool added = false;
+    return put(root_, key, V(), added);
+  }
+  //----< pointer to this map's own copy of value, nullptr if none >---
+  /*
+  *  - copies the path to key where it is shared, so other copies of
+  *    the map don't see changes made through the pointer
+  */
+  template<typename K, typename V>
+  V* PersistentMap<K, V>::modify(const K& key)
+  {
+    Link* pLink = &root_;
+    while (*pLink)
+    {
+      own(*pLink);
+      Node& node = **pLink;
+      if (key < node.pItem->first)
+        pLink = &node.left;
+      else if (node.pItem->first < key)
+        pLink = &node.right;
+      else
+      {
+        own(node.pItem);
+        return &node.pItem->second;
+      }
+    }
+    return nullptr;
+  }
+  //----< add or replace value at key, returns true if added >---------
+
+  template<typename K, typename V>
+  bool PersistentMap<K, V>::insert(const K& key, const V& value)
+  {
+    bool added = false;
+    put(root_, key, value, added);
+    return added;
+  }
+  //----< remove key, returns number of entries removed >--------------
+
+  template<typename K, typename V>
+  size_t PersistentMap<K, V>::erase(const K& key)
+  {
+    if (!contains(key))
+      return 0;
+    remove(root_, key);
+    return 1;
+  }
+  //----< pseudo-random treap priority for a new node >---------------
+
+  template<typename K, typename V>
+  size_t PersistentMap<K, V>::nextPriority()
+  {
+    static std::atomic<unsigned long long> count(0);
+    unsigned long long bits = ++count * 0x9e3779b97f4a7c15ULL;
+    bits ^= bits >> 31;
+    bits *= 0xbf58476d1ce4e5b9ULL;
+    bits ^= bits >> 29;
+    return static_cast<size_t>(bits);
+  }
+  //----< make pShared point to an object no other copy shares >-------
+  /*
+  *  - a count of one can't rise again, since only this copy reaches the
+  *    object, so the acquire fence orders our writes after the last
+  *    reads made by copies that have released it
+  */
+  template<typename K, typename V>
+  template<typename T>
+  void PersistentMap<K, V>::own(std::shared_ptr<T>& pShared)
+  {
+    if (pShared.use_count() > 1)
+      pShared = std::make_shared<T>(*pShared);
+    else
+      std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  //----< add or replace value in subtree at node >--------------------
+
+  template<typename K, typename V>
+  V& PersistentMap<K, V>::put(Link& node, const K& key, const V& value, bool& added)
+  {
+    if (!node)
+    {
+      node = std::make_shared<Node>(key, value);
+      added = true;
+      return node->pItem->second;
+    }
+    own(node);
+    if (key < node->pItem->first)
+    {
+      V& result = put(node->left, key, value, added);
+      resize(*node);
+      if (node->left->priority > node->priority)
+        rotateRight(node);
+      return result;
+    }
+    if (node->pItem->first < key)
+    {
+      V& result = put(node->right, key, value, added);
+      resize(*node);
+      if (node->right->priority > node->priority)
+        rotateLeft(node);
+      return result;
+    }
+    node->pItem = std::make_shared<value_type>(key, value);
+    return node->pItem->second;
+  }
+  //----< remove key from subtree at node, which must hold it >--------
+
+  template<typename K, typename V>
+  bool PersistentMap<K, V>::remove(Link& node, const K& key)
+  {
+    if (!node)
+      return false;
+    own(node);
+    bool removed = false;
+    if (key < node->pItem->first)
+      removed = remove(node->left, key);
+    else if (node->pItem->first < key)
+      removed = remove(node->right, key);
+    else
+    {
+      node = merge(std::move(node->left), std::move(node->right));
+      return true;
+    }
+    resize(*node);
+    return removed;
+  }
+  //----< join subtrees whose keys are all less than right's >---------
+
+  template<typename K, typename V>
+  typename PersistentMap<K, V>::Link PersistentMap<K, V>::merge(Link left, Link right)
+  {
+    if (!left)
+      return right;
+    if (!right)
+      return left;
+    if (left->priority > right->priority)
+    {
+      own(left);
+      left->right = merge(std::move(left->right), std::move(right));
+      resize(*left);
+      return left;
+    }
+    own(right);
+    right->left = merge(std::move(left), std::move(right->left));
+    resize(*right);
+    return right;
+  }
+  //----< lift node's right child, node must be owned >----------------
+
+  template<typename K, typename V>
+  void PersistentMap<K, V>::rotateLeft(Link& node)
+  {
+    Link child = std::move(node->right);
+    node->right = std::move(child->left);
+    resize(*node);
+    child->left = std::move(node);
+    resize(*child);
+    node = std::move(child);
+  }
+  //----< lift node's left child, node must be owned >-----------------
+
+  template<typename K, typename V>
+  void PersistentMap<K, V>::rotateRight(Link& node)
+  {
+    Link child = std::move(node->left);
+    node->left = std::move(child->right);
+    resize(*node);
+    child->right = std::move(node);
+    resize(*child);
+    node = std::move(child);
+  }
+}
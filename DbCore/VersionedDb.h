@@ -0,0 +1,250 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// VersionedDb.h - multi-version concurrency control for DbCore        //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides two classes:
+* - KeyLocks is a fixed set of mutexes, each guarding the keys that
+*   hash to it.  Locking a set of keys locks their mutexes in order,
+*   so writers that lock overlapping key sets can't deadlock.
+* - VersionedDb<P> shares a DbCore<P> between many reader and writer
+*   threads:
+*   - read() returns the latest committed version, a snapshot that
+*     never changes, so readers never wait for writers.  Snapshots are
+*     read-only: use find, begin/end, keys, contains, parents, and,
+*     if the db uses them, indexes, never operator[] or the methods
+*     that change records.
+*   - begin(keys) starts a Transaction that holds the locks for keys
+*     and edits a private copy of the latest version.  Copies share
+*     every record they don't change (see PersistentMap.h), so starting
+*     and committing a transaction costs O(log n) per changed record.
+*     Writers that lock different keys run in parallel.
+*   - Transaction::commit() publishes the copy as the next version.  If
+*     another writer committed first, only the records this writer
+*     changed are applied to the newer version.
+*
+* Writers that may change the same record must lock a common key.
+*
+* Required Files:
+* ---------------
+* VersionedDb.h, DbCore.h, DbIndex.h, PersistentMap.h, Definitions.h
+* DateTime.h, DateTime.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 17th October 2026
+* - transaction and merge copies share records with the version they
+*   copy, instead of copying the whole db
+* - removeRecord retries if a parent was added before its keys were
+*   locked
+* ver 1.1 : 17th October 2026
+* - commit merges records with putRecord instead of operator[]
+* - commit releases the records a transaction reached with operator[]
+* ver 1.0 : 17th October 2026
+* - first release
+*/
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include "DbCore.h"
+
+namespace NoSqlDb
+{
+  /////////////////////////////////////////////////////////////////////
+  // KeyLocks class
+  // - keys share a mutex when they hash to the same stripe
+
+  class KeyLocks
+  {
+  public:
+    using Guard = std::vector<std::unique_lock<std::mutex>>;
+    static const size_t numStripes = 64;
+
+    Guard lock(const Keys& keys);
+  private:
+    std::mutex stripes_[numStripes];
+  };
+  //----< lock every stripe holding one of keys, in stripe order >-----
+
+  inline KeyLocks::Guard KeyLocks::lock(const Keys& keys)
+  {
+    std::set<size_t> stripes;
+    for (auto& key : keys)
+      stripes.insert(std::hash<Key>()(key) % numStripes);
+    Guard guard;
+    for (size_t stripe : stripes)
+      guard.emplace_back(stripes_[stripe]);
+    return guard;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // VersionedDb class
+  // - readers share immutable snapshots, writers lock only their keys
+
+  template<typename P>
+  class VersionedDb
+  {
+  public:
+    using Snapshot = std::shared_ptr<DbCore<P>>;
+    class Transaction;
+
+    VersionedDb() : current_(std::make_shared<DbCore<P>>()) {}
+    VersionedDb(const VersionedDb&) = delete;
+    VersionedDb& operator=(const VersionedDb&) = delete;
+
+    Snapshot read();
+    Transaction begin(const Keys& lockKeys);
+    bool removeRecord(const Key& key);
+    size_t version();
+  private:
+    void commit(Snapshot base, Snapshot draft);
+
+    Snapshot current_;
+    KeyLocks keyLocks_;
+    std::mutex commitMtx_;
+    size_t version_ = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // Transaction class
+  // - changes are discarded unless committed
+  // - key locks are held until the transaction is committed or destroyed
+
+  template<typename P>
+  class VersionedDb<P>::Transaction
+  {
+  public:
+    Transaction(VersionedDb<P>& vdb, KeyLocks::Guard guard);
+    DbCore<P>& db() { return *draft_; }
+    void commit();
+  private:
+    VersionedDb<P>* pVdb_;
+    KeyLocks::Guard guard_;
+    Snapshot base_;
+    Snapshot draft_;
+  };
+  //----< copy latest version, tracking changes made to the copy >-----
+  /*
+  *  - the copy shares all records with the latest version, see DbCore
+  */
+
+  template<typename P>
+  VersionedDb<P>::Transaction::Transaction(VersionedDb<P>& vdb, KeyLocks::Guard guard)
+    : pVdb_(&vdb), guard_(std::move(guard)), base_(vdb.read())
+  {
+    draft_ = std::make_shared<DbCore<P>>(*base_);
+    draft_->trackChanges(true);
+  }
+  //----< publish changes as the next version and release key locks >-
+
+  template<typename P>
+  void VersionedDb<P>::Transaction::commit()
+  {
+    if (!draft_)
+      throw(std::exception("transaction already committed"));
+    pVdb_->commit(base_, draft_);
+    draft_.reset();
+    guard_.clear();
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // VersionedDb<P> methods
+
+  //----< return latest committed version >----------------------------
+  /*
+  *  - never blocks on writers
+  */
+  template<typename P>
+  typename VersionedDb<P>::Snapshot VersionedDb<P>::read()
+  {
+    return std::atomic_load(&current_);
+  }
+  //----< lock keys and start editing a copy of the latest version >---
+
+  template<typename P>
+  typename VersionedDb<P>::Transaction VersionedDb<P>::begin(const Keys& lockKeys)
+  {
+    return Transaction(*this, keyLocks_.lock(lockKeys));
+  }
+  //----< remove record, locking key and its parents >-----------------
+  /*
+  *  - parents are read before their keys are locked, so if another
+  *    writer added a parent meanwhile, the transaction is dropped and
+  *    retried with that parent locked too
+  */
+  template<typename P>
+  bool VersionedDb<P>::removeRecord(const Key& key)
+  {
+    Keys lockKeys = read()->parents(key);
+    lockKeys.push_back(key);
+    while (true)
+    {
+      Transaction trans = begin(lockKeys);
+      Keys parents = trans.db().parents(key);
+      bool allLocked = true;
+      for (auto& parent : parents)
+      {
+        if (std::find(lockKeys.begin(), lockKeys.end(), parent) == lockKeys.end())
+        {
+          lockKeys.push_back(parent);
+          allLocked = false;
+        }
+      }
+      if (!allLocked)
+        continue;
+      bool removed = trans.db().removeRecord(key);
+      trans.commit();
+      return removed;
+    }
+  }
+  //----< number of versions committed >-------------------------------
+
+  template<typename P>
+  size_t VersionedDb<P>::version()
+  {
+    std::lock_guard<std::mutex> lock(commitMtx_);
+    return version_;
+  }
+  //----< publish draft, merging it if base is no longer latest >------
+  /*
+  *  - the common, uncontended case publishes draft as it is
+  *  - otherwise draft's changed records are copied into, or removed
+  *    from, a copy of the latest version, which shares its other records
+  */
+  template<typename P>
+  void VersionedDb<P>::commit(Snapshot base, Snapshot draft)
+  {
+    std::lock_guard<std::mutex> lock(commitMtx_);
+    Snapshot latest = read();
+    Snapshot next = draft;
+    if (latest != base)
+    {
+      next = std::make_shared<DbCore<P>>(*latest);
+      for (auto& key : draft->changes())
+      {
+        typename DbCore<P>::iterator iter = draft->find(key);
+        if (iter != draft->end())
+          next->putRecord(key, iter->second);
+        else
+          next->removeRecord(key);
+      }
+    }
+    next->trackChanges(false);
+    next->release();
+    std::atomic_store(&current_, next);
+    ++version_;
+  }
+}
@@ -0,0 +1,476 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// WriteAheadLog.h - append-only log of DbCore changes                 //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides the WriteAheadLog class.  It records the
+* changes made to a DbCore<P> since its last snapshot was saved, so
+* saving a change costs the size of the change, not of the database.
+* - a batch holds the entries for one change: whole records that were
+*   added or edited, keys of removed records, and version numbers.
+*   logChanges adds an entry for every record a DbCore has changed.
+* - append(batch) queues the batch and returns its ticket.  sync(ticket)
+*   returns once the batch is on disk.  The first thread to sync writes
+*   and flushes every queued batch at once, while later threads queue
+*   the next group, so one flush commits many concurrent changes.
+* - each batch is framed by its size and CRC-32.  replay applies every
+*   whole batch to a db loaded from the last snapshot, and cuts off a
+*   batch that was only partly written when the process stopped.
+* - checkpoint(ticket, preamble) drops batches up to ticket, once a
+*   snapshot holding them is safely saved.  The preamble batch replaces
+*   them, for state the snapshot does not hold.  size() tells callers
+*   when the log has grown enough to be worth a checkpoint.
+* Replaying a batch twice leaves the same result, so a snapshot may
+* already hold changes that are still in the log.
+*
+* Call replay before the first append.
+*
+* Required Files:
+* ---------------
+* WriteAheadLog.h, BinaryCodec.h, DbCore.h, Definitions.h
+* DateTime.h, DateTime.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 17th October 2026
+* - records are replayed with putRecord instead of operator[]
+* - added size
+* ver 1.0 : 17th October 2026
+* - first release
+*/
+
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "DbCore.h"
+#include "BinaryCodec.h"
+
+namespace NoSqlDb
+{
+  /////////////////////////////////////////////////////////////////////
+  // WriteAheadLog class
+  // - tickets are byte positions in the log, counted from its start
+
+  class WriteAheadLog
+  {
+  public:
+    using Ticket = size_t;
+    using Versions = std::unordered_map<Key, size_t>;
+    enum Op { putRecord = 1, removeRecord = 2, setVersion = 3 };
+    static const size_t FrameHeader = 8;
+
+    explicit WriteAheadLog(const std::string& path);
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    template<typename P>
+    static void logChanges(std::string& batch, DbCore<P>& db);
+    template<typename P>
+    static void logRecord(std::string& batch, const Key& key, const DbElement<P>& elem);
+    static void logRemove(std::string& batch, const Key& key);
+    static void logVersion(std::string& batch, const Key& key, size_t version);
+
+    template<typename P>
+    size_t replay(DbCore<P>& db, Versions& versions);
+    Ticket append(const std::string& batch);
+    void sync(Ticket ticket);
+    Ticket end();
+    bool checkpoint(Ticket upTo, const std::string& preamble);
+    size_t size();
+    size_t flushes();
+
+    static void replaceFile(const std::string& tmpPath, const std::string& path);
+    static void restoreFile(const std::string& tmpPath, const std::string& path);
+  private:
+    template<typename P>
+    static void apply(Binary::Reader& in, DbCore<P>& db, Versions& versions);
+    static void frame(std::string& out, const std::string& batch);
+    static bool writeAll(int fd, const std::string& bytes);
+    bool write(const std::string& bytes);
+    bool rewrite(const std::string& preamble, size_t from, size_t to);
+    void truncate(size_t size);
+    void close();
+
+    std::string path_;
+    int fd_ = -1;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::string pending_;
+    std::string writing_;
+    Ticket appended_ = 0;
+    Ticket durable_ = 0;
+    Ticket checkpoint_ = 0;
+    Ticket markTicket_ = 0;
+    size_t markPos_ = 0;
+    bool flushing_ = false;
+    bool failed_ = false;
+    size_t flushes_ = 0;
+  };
+  //----< recover an interrupted checkpoint, count existing bytes >----
+
+  inline WriteAheadLog::WriteAheadLog(const std::string& path) : path_(path)
+  {
+    restoreFile(path_ + ".tmp", path_);
+    std::ifstream in(path_, std::ios::binary | std::ios::ate);
+    if (in.good())
+      appended_ = durable_ = static_cast<size_t>(in.tellg());
+    markTicket_ = markPos_ = appended_;
+  }
+  //----< write any batches not yet synced, then close log >-----------
+
+  inline WriteAheadLog::~WriteAheadLog()
+  {
+    try
+    {
+      sync(end());
+    }
+    catch (...) {}
+    close();
+  }
+  //----< add an entry for each record db has changed >----------------
+  /*
+  *  - db must be tracking changes, e.g., a VersionedDb transaction
+  */
+  template<typename P>
+  void WriteAheadLog::logChanges(std::string& batch, DbCore<P>& db)
+  {
+    for (auto& key : db.changes())
+    {
+      typename DbCore<P>::iterator iter = db.find(key);
+      if (iter != db.end())
+        logRecord(batch, key, iter->second);
+      else
+        logRemove(batch, key);
+    }
+  }
+  //----< add entry that sets key's record to elem >-------------------
+
+  template<typename P>
+  void WriteAheadLog::logRecord(std::string& batch, const Key& key, const DbElement<P>& elem)
+  {
+    batch.push_back(putRecord);
+    Binary::appendString(batch, key);
+    Binary::Writer out(batch);
+    Binary::appendElement(out, elem);
+  }
+  //----< add entry that removes key's record >------------------------
+
+  inline void WriteAheadLog::logRemove(std::string& batch, const Key& key)
+  {
+    batch.push_back(removeRecord);
+    Binary::appendString(batch, key);
+  }
+  //----< add entry that raises key's version to at least version >----
+
+  inline void WriteAheadLog::logVersion(std::string& batch, const Key& key, size_t version)
+  {
+    batch.push_back(setVersion);
+    Binary::appendString(batch, key);
+    Binary::appendVarint(batch, version);
+  }
+  //----< apply logged batches to db and versions >--------------------
+  /*
+  *  - stops at the first batch that is incomplete or fails its checksum
+  *    and cuts the log there, so new batches follow the last good one
+  *  - returns number of entries applied
+  */
+  template<typename P>
+  size_t WriteAheadLog::replay(DbCore<P>& db, Versions& versions)
+  {
+    std::string bytes;
+    {
+      std::ifstream in(path_, std::ios::binary);
+      bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    size_t pos = 0;
+    size_t applied = 0;
+    while (bytes.size() - pos >= FrameHeader)
+    {
+      uint32_t size = Binary::readFixed32(&bytes[pos]);
+      uint32_t crc = Binary::readFixed32(&bytes[pos + 4]);
+      if (size > bytes.size() - pos - FrameHeader)
+        break;
+      const char* pBatch = bytes.data() + pos + FrameHeader;
+      if (Binary::crc32(pBatch, size) != crc)
+        break;
+      Binary::Reader in(pBatch, pBatch + size);
+      while (!in.done())
+      {
+        apply(in, db, versions);
+        ++applied;
+      }
+      pos += FrameHeader + size;
+    }
+    if (pos < bytes.size())
+      truncate(pos);
+    std::lock_guard<std::mutex> lock(mtx_);
+    appended_ = durable_ = markTicket_ = markPos_ = pos;
+    checkpoint_ = 0;
+    return applied;
+  }
+  //----< apply one entry >--------------------------------------------
+
+  template<typename P>
+  void WriteAheadLog::apply(Binary::Reader& in, DbCore<P>& db, Versions& versions)
+  {
+    char op = in.readByte();
+    Key key = in.readString();
+    if (op == putRecord)
+      db.putRecord(key, Binary::readElement<P>(in));
+    else if (op == removeRecord)
+      db.removeRecord(key);
+    else if (op == setVersion)
+    {
+      size_t version = static_cast<size_t>(in.readVarint());
+      size_t& current = versions[key];
+      if (current < version)
+        current = version;
+    }
+    else
+      throw std::exception("unknown write-ahead log entry");
+  }
+  //----< queue batch to be written, returns its ticket >--------------
+
+  inline WriteAheadLog::Ticket WriteAheadLog::append(const std::string& batch)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_t size = pending_.size();
+    frame(pending_, batch);
+    appended_ += pending_.size() - size;
+    return appended_;
+  }
+  //----< wait until every batch up to ticket is on disk >-------------
+  /*
+  *  - a thread that finds no flush running becomes the leader: it takes
+  *    every queued batch, writes them, and flushes them with one _commit
+  *  - other threads wait for the leader, and the next leader takes
+  *    whatever they queued in the meantime
+  */
+  inline void WriteAheadLog::sync(Ticket ticket)
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (durable_ < ticket)
+    {
+      if (failed_)
+        throw std::exception("write-ahead log write failed");
+      if (flushing_)
+      {
+        cv_.wait(lock);
+        continue;
+      }
+      flushing_ = true;
+      writing_.clear();
+      writing_.swap(pending_);
+      Ticket upTo = appended_;
+      lock.unlock();
+      bool written = write(writing_);
+      lock.lock();
+      flushing_ = false;
+      if (written)
+      {
+        durable_ = upTo;
+        ++flushes_;
+      }
+      else
+        failed_ = true;
+      cv_.notify_all();
+    }
+  }
+  //----< ticket of the last batch appended >--------------------------
+
+  inline WriteAheadLog::Ticket WriteAheadLog::end()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return appended_;
+  }
+  //----< drop batches up to upTo, starting the log with preamble >----
+  /*
+  *  - call only after a snapshot holding every batch up to upTo is saved
+  *  - batches after upTo are kept, and appends continue while the log
+  *    is rewritten
+  *  - returns false, leaving the log unchanged, if it can't be rewritten
+  */
+  inline bool WriteAheadLog::checkpoint(Ticket upTo, const std::string& preamble)
+  {
+    sync(upTo);
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this]() { return !flushing_; });
+    if (upTo <= checkpoint_ || upTo < markTicket_ || failed_)
+      return false;
+    flushing_ = true;
+    size_t from = markPos_ + (upTo - markTicket_);
+    size_t to = markPos_ + (durable_ - markTicket_);
+    lock.unlock();
+    std::string framed;
+    if (preamble.size() > 0)
+      frame(framed, preamble);
+    bool rewritten = rewrite(framed, from, to);
+    lock.lock();
+    flushing_ = false;
+    if (rewritten)
+    {
+      checkpoint_ = markTicket_ = upTo;
+      markPos_ = framed.size();
+    }
+    cv_.notify_all();
+    return rewritten;
+  }
+  //----< bytes in the log, including batches not yet synced >--------
+
+  inline size_t WriteAheadLog::size()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return markPos_ + (appended_ - markTicket_);
+  }
+  //----< number of flushes to disk, each commits one or more batches >-
+
+  inline size_t WriteAheadLog::flushes()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return flushes_;
+  }
+  //----< flush tmpPath to disk, then move it over path >--------------
+  /*
+  *  - a crash after path is removed leaves tmpPath, see restoreFile
+  */
+  inline void WriteAheadLog::replaceFile(const std::string& tmpPath, const std::string& path)
+  {
+    int fd = ::_open(tmpPath.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd < 0)
+      throw std::exception("can't open file to replace");
+    int flushed = ::_commit(fd);
+    ::_close(fd);
+    if (flushed != 0)
+      throw std::exception("can't flush file to replace");
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+      throw std::exception("can't replace file");
+  }
+  //----< finish or discard a replaceFile that was interrupted >-------
+  /*
+  *  - tmpPath is complete if path was already removed, otherwise it
+  *    may be partly written
+  */
+  inline void WriteAheadLog::restoreFile(const std::string& tmpPath, const std::string& path)
+  {
+    if (!std::ifstream(tmpPath).good())
+      return;
+    if (std::ifstream(path).good())
+      std::remove(tmpPath.c_str());
+    else
+      std::rename(tmpPath.c_str(), path.c_str());
+  }
+  //----< append batch to out, after its size and checksum >-----------
+
+  inline void WriteAheadLog::frame(std::string& out, const std::string& batch)
+  {
+    Binary::appendFixed32(out, static_cast<uint32_t>(batch.size()));
+    Binary::appendFixed32(out, Binary::crc32(batch.data(), batch.size()));
+    out.append(batch);
+  }
+  //----< write all of bytes to fd >-----------------------------------
+
+  inline bool WriteAheadLog::writeAll(int fd, const std::string& bytes)
+  {
+    const size_t MaxWrite = 1 << 30;
+    size_t done = 0;
+    while (done < bytes.size())
+    {
+      size_t size = bytes.size() - done;
+      if (size > MaxWrite)
+        size = MaxWrite;
+      int written = ::_write(fd, bytes.data() + done, static_cast<unsigned>(size));
+      if (written <= 0)
+        return false;
+      done += written;
+    }
+    return true;
+  }
+  //----< append bytes to log and flush them to disk >-----------------
+  /*
+  *  - called only by the thread that set flushing_
+  */
+  inline bool WriteAheadLog::write(const std::string& bytes)
+  {
+    if (fd_ < 0)
+      fd_ = ::_open(path_.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd_ < 0)
+      return false;
+    return writeAll(fd_, bytes) && ::_commit(fd_) == 0;
+  }
+  //----< replace log with preamble and its bytes from, up to to >-----
+  /*
+  *  - called only by the thread that set flushing_
+  */
+  inline bool WriteAheadLog::rewrite(const std::string& preamble, size_t from, size_t to)
+  {
+    std::string bytes(preamble);
+    {
+      std::ifstream in(path_, std::ios::binary);
+      in.seekg(from);
+      bytes.resize(preamble.size() + (to - from));
+      if (!in.read(&bytes[preamble.size()], to - from))
+        return false;
+    }
+    std::string tmpPath = path_ + ".tmp";
+    int fd = ::_open(tmpPath.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd < 0)
+      return false;
+    bool written = writeAll(fd, bytes);
+    ::_close(fd);
+    if (!written)
+    {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+    close();
+    try
+    {
+      replaceFile(tmpPath, path_);
+    }
+    catch (std::exception&)
+    {
+      restoreFile(tmpPath, path_);
+      return false;
+    }
+    return true;
+  }
+  //----< cut log to size bytes >--------------------------------------
+
+  inline void WriteAheadLog::truncate(size_t size)
+  {
+    close();
+    int fd = ::_open(path_.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd < 0)
+      throw std::exception("can't open write-ahead log");
+    bool cut = ::_chsize_s(fd, size) == 0 && ::_commit(fd) == 0;
+    ::_close(fd);
+    if (!cut)
+      throw std::exception("can't truncate write-ahead log");
+  }
+  //----< close log, the next write reopens it >-----------------------
+
+  inline void WriteAheadLog::close()
+  {
+    if (fd_ >= 0)
+      ::_close(fd_);
+    fd_ = -1;
+  }
+}
@@ -23,6 +23,8 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.1 : 17 Oct 2026
+*  - test stub edits a record held in a db
 *  ver 1.0 : 17 Feb 2018
 *  - first release
 */
@@ -53,6 +55,18 @@ int main()
   edt -= DateTime::makeDuration(48, 0);
   edit.payLoad("edited elem payload");
   showElem(edit.DbElement());
+
+  Utilities::Title("Demonstrating Edits of a record in a db");
+
+  DbCore<std::string> db;
+  db["parent"] = elem;
+  db["child"] = elem;
+  Edit<std::string> dbEdit(db, "parent");
+  std::cout << "\n  parents of child before edit: " << db.parents("child").size();
+  dbEdit.addChildKey("child");
+  std::cout << "\n  parents of child after adding child key: " << db.parents("child").size();
+  dbEdit.removeChildKey("child");
+  std::cout << "\n  parents of child after removing child key: " << db.parents("child").size();
   std::cout << "\n\n";
 }
 #endif
\ No newline at end of file
@@ -15,6 +15,9 @@
 *  This package defines a single Edit class that:
 *  - accepts a DbElement<P> instance when constructed
 *  - provides facilities to edit it's metadata
+*  An Edit constructed from a db and key finds the record in the db for
+*  each edit and then has the db reindex it, so its db's parent and
+*  secondary indexes see every edit, however long the Edit is kept.
 *
 *  Required Files:
 *  ---------------
@@ -24,6 +27,11 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.2 : 17 Oct 2026
+*  - an Edit made from a db and key reindexes the record after each edit,
+*    instead of holding a reference to it
+*  ver 1.1 : 17 Oct 2026
+*  - added constructor taking db and key, so child edits reach parent index
 *  ver 1.0 : 17 Feb 2018
 *  - first release
 */
@@ -40,7 +48,8 @@ namespace NoSqlDb
   class Edit
   {
   public:
-    Edit(DbElement<P>& elem) : elem_(elem) {}
+    Edit(DbElement<P>& elem) : pElem_(&elem) {}
+    Edit(DbCore<P>& db, const Key& key) : pDb_(&db), key_(key) {}
     static void identify(std::ostream& = std::cout);
     void name(const std::string& name);
     void description(const std::string& descrip);
@@ -51,9 +60,13 @@ namespace NoSqlDb
     bool removeChildKey(const Key& key);
     P& payLoad();
     void payLoad(const P& p);
-    DbElement<P> DbElement() { return elem_; }
+    DbElement<P> DbElement() { return element(); }
   private:
-    NoSqlDb::DbElement<P>& elem_;
+    NoSqlDb::DbElement<P>& element();
+    void edited();
+    NoSqlDb::DbElement<P>* pElem_ = nullptr;
+    DbCore<P>* pDb_ = nullptr;
+    Key key_;
   };
 
   //----< show file name >---------------------------------------------
@@ -63,49 +76,75 @@ namespace NoSqlDb
   {
     out << "\n  \"" << __FILE__ << "\"";
   }
+  //----< element being edited, found in the db for each edit >--------
+
+  template<typename P>
+  NoSqlDb::DbElement<P>& Edit<P>::element()
+  {
+    if (pDb_ != nullptr)
+      return (*pDb_)[key_];
+    return *pElem_;
+  }
+  //----< have the db reindex the record just edited >-----------------
+
+  template<typename P>
+  void Edit<P>::edited()
+  {
+    if (pDb_ != nullptr)
+      pDb_->reindex(key_);
+  }
   template<typename P>
   void Edit<P>::name(const std::string& name)
   {
-    elem_.name(name);
+    element().name(name);
+    edited();
   }
   template<typename P>
   void Edit<P>::description(const std::string& descrip)
   {
-    elem_.descrip(descrip);
+    element().descrip(descrip);
+    edited();
   }
   template<typename P>
   DateTime& Edit<P>::dateTime()
   {
-    return elem_.dateTime();
+    return element().dateTime();
   }
   template<typename P>
   void Edit<P>::dateTime(const DateTime& dt)
   {
-    elem_.dateTime(dt);
+    element().dateTime(dt);
+    edited();
   }
   template<typename P>
   void Edit<P>::clearChildKeys()
   {
-    elem_.children().clear();
+    element().children().clear();
+    edited();
   }
   template<typename P>
   bool Edit<P>::addChildKey(const Key& key)
   {
-    return elem_.addChildKey(key);
+    bool added = element().addChildKey(key);
+    edited();
+    return added;
   }
   template<typename P>
   bool Edit<P>::removeChildKey(const Key& key)
   {
-    return elem_.removeChildKey(key);
+    bool removed = element().removeChildKey(key);
+    edited();
+    return removed;
   }
   template<typename P>
   P& Edit<P>::payLoad()
   {
-    return elem_.payLoad();
+    return element().payLoad();
   }
   template<typename P>
   void Edit<P>::payLoad(const P& p)
   {
-    elem_.payLoad(p);
+    element().payLoad(p);
+    edited();
   }
 }
\ No newline at end of file
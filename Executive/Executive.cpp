@@ -53,7 +53,7 @@ int main()
 	Utilities::title("demonstrating query");
   Query<PayLoad> q(db);
   q.select(
-    [=](DbElement<PayLoad>& elem) { 
+    [=](const DbElement<PayLoad>& elem) { 
       if (elem.name() == name2)
       {
         std::cout << "\n  " << elem.name();
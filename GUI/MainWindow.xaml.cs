@@ -17,6 +17,8 @@
  * - It provides a subdirectory list and a filelist for the selected directory.
  * - You can navigate into subdirectories by double-clicking on subdirectory
  *   or the parent directory, indicated by the name "..".
+ * - A request the server is too busy to accept comes back marked "server busy".
+ *   It is reposted after the server's retryAfter delay, doubled on each retry.
  *   
  * Required Files:
  * ---------------
@@ -25,6 +27,8 @@
  * 
  * Maintenance History:
  * --------------------
+ * ver 2.1 : 17th October 2026
+ *  - reposts requests answered with "server busy", backing off exponentially
  * ver 2.0 : 27th April 2018
  *  - second release
  * ver 1.0 : 6th April 2018
@@ -71,6 +75,7 @@ namespace WpfApp1
         private string path;
         private Dictionary<string, Action<CsMessage>> dispatcher_ 
         = new Dictionary<string, Action<CsMessage>>();
+        private const int maxRetries = 5;
 
         //----< process incoming messages on child thread >----------------
 
@@ -82,6 +87,11 @@ namespace WpfApp1
                     CsMessage msg = translater.getMessage();
                     try
                     {
+                        if (msg.attributes.ContainsKey("error") && msg.value("error") == "server busy")
+                        {
+                            retryLater(msg);
+                            continue;
+                        }
                         string msgId = msg.value("command");
                         if (msgId.Length > 0 && dispatcher_.ContainsKey(msgId))
                             dispatcher_[msgId].Invoke(msg);
@@ -97,6 +107,38 @@ namespace WpfApp1
             rcvThrd.Start();
         }
 
+        //----< repost request the server was too busy to accept >--------
+        /*
+         * - waits retryAfter millisec, doubled for each earlier retry
+         * - gives up after maxRetries
+         */
+        private void retryLater(CsMessage msg)
+        {
+            int retries = 0;
+            if (msg.attributes.ContainsKey("retries"))
+                int.TryParse(msg.value("retries"), out retries);
+            int retryAfter = 500;
+            if (msg.attributes.ContainsKey("retryAfter"))
+                int.TryParse(msg.value("retryAfter"), out retryAfter);
+            string command = msg.value("command");
+            if (retries >= maxRetries)
+            {
+                Action giveUp = () => { StatusBarText.Text = "Server busy, gave up on " + command; };
+                Dispatcher.Invoke(giveUp, new Object[] { });
+                return;
+            }
+            string to = msg.value("to");
+            msg.attributes["to"] = msg.value("from");
+            msg.attributes["from"] = to;
+            msg.remove("error");
+            msg.remove("retryAfter");
+            msg.attributes["retries"] = (retries + 1).ToString();
+            int delay = retryAfter << retries;
+            Action busy = () => { StatusBarText.Text = "Server busy, retrying " + command + " in " + delay + " ms"; };
+            Dispatcher.Invoke(busy, new Object[] { });
+            Task.Delay(delay).ContinueWith(t => translater.postMessage(msg));
+        }
+
         //----< function dispatched by child thread to main thread >-------
         private void clearDirs(string cmd)
         {
@@ -19,7 +19,13 @@
 *  - provides methods used by Persist<PayLoad>:
 *    - Sptr toXmlElement();
 *    - static PayLoad fromXmlElement(Sptr elem);
+*    - void toXml(XmlWriter& out) const;
+*  - provides the binary hooks used by WriteAheadLog and binary snapshots:
+*    - void serialize(Binary::Writer& out) const;
+*    - static PayLoad deserialize(Binary::Reader& in);
 *  - provides a show function to display PayLoad specific information
+*  - specializes IndexTraits so DbCore<PayLoad> can index categories
+*    and status
 *  - PayLoad processing is very simple, so this package contains only
 *    a header file, making it easy to use in other packages, e.g.,
 *    just include the PayLoad.h header.
@@ -27,10 +33,21 @@
 *  Required Files:
 *  ---------------
 *    PayLoad.h, PayLoad.cpp - application defined package
-*    DbCore.h, DbCore.cpp
+*    DbCore.h, DbCore.cpp, BinaryCodec.h, XmlWriter.h
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.5 : 17 Oct 2026
+*  - added toXml, which streams the payload through an XmlWriter
+*  ver 1.4 : 17 Oct 2026
+*  - serialize writes to a Binary::Writer, so binary snapshots can
+*    share repeated strings
+*  ver 1.3 : 17 Oct 2026
+*  - added binary serialize and deserialize, which also keep status
+*    and isClose
+*  - fromXmlElement skips empty elements, e.g., no categories
+*  ver 1.2 : 17 Oct 2026
+*  - added IndexTraits<PayLoad> specialization
 *  ver 1.1 : 19 Feb 2018
 *  - added inheritance from IPayLoad interface
 *  Ver 1.0 : 10 Feb 2018
@@ -43,8 +60,10 @@
 #include <iostream>
 #include "../XmlDocument/XmlDocument/XmlDocument.h"
 #include "../XmlDocument/XmlElement/XmlElement.h"
+#include "../XmlDocument/XmlWriter/XmlWriter.h"
 #include "../DbCore/Definitions.h"
 #include "../DbCore/DbCore.h"
+#include "../DbCore/BinaryCodec.h"
 #include "IPayLoad.h"
 
 ///////////////////////////////////////////////////////////////////////
@@ -55,6 +74,7 @@
 // - methods used by Persist<PayLoad>:
 //   - Sptr toXmlElement();
 //   - static PayLoad fromXmlElement(Sptr elem);
+//   - void toXml(XmlWriter& out) const;
 
 
 namespace NoSqlDb
@@ -101,6 +121,9 @@ namespace NoSqlDb
 
     Sptr toXmlElement();
     static PayLoad fromXmlElement(Sptr elem);
+    void toXml(XmlProcessing::XmlWriter& out) const;
+    void serialize(Binary::Writer& out) const;
+    static PayLoad deserialize(Binary::Reader& in);
 
     static void showPayLoadHeaders(std::ostream& out = std::cout);
     static void showElementPayLoad(NoSqlDb::DbElement<PayLoad>& elem, std::ostream& out = std::cout);
@@ -108,10 +131,21 @@ namespace NoSqlDb
   private:
     std::string value_;
 	std::string status_;
-	bool isClose_;
+	bool isClose_ = false;
     std::vector<std::string> categories_;
   };
 
+  /////////////////////////////////////////////////////////////////////
+  // IndexTraits<PayLoad>
+  // - tells DbIndex which PayLoad fields to index
+
+  template<>
+  struct IndexTraits<PayLoad>
+  {
+    static Keys categories(const PayLoad& pl) { return pl.categories(); }
+    static std::string status(const PayLoad& pl) { return pl.status(); }
+  };
+
   //----< show file name >---------------------------------------------
 
   inline void PayLoad::identify(std::ostream& out)
@@ -146,6 +180,8 @@ namespace NoSqlDb
     PayLoad pl;
     for (auto pChild : pElem->children())
     {
+      if (pChild->children().size() == 0)
+        continue;
       std::string tag = pChild->tag();
       std::string val = pChild->children()[0]->value();
       if (tag == "value")
@@ -163,6 +199,48 @@ namespace NoSqlDb
     }
     return pl;
   }
+  //----< write PayLoad instance as XML, like toXmlElement >-----------
+  /*
+  * - Required by Persist<PayLoad>
+  */
+  inline void PayLoad::toXml(XmlProcessing::XmlWriter& out) const
+  {
+    out.start("payload");
+    out.element("value", value_);
+    out.start("categories");
+    for (auto& cat : categories_)
+      out.element("category", cat);
+    out.end();
+    out.end();
+  }
+  //----< write binary form of PayLoad instance to out >---------------
+  /*
+  * - Required by WriteAheadLog and Persist<PayLoad>::toBinary
+  */
+  inline void PayLoad::serialize(Binary::Writer& out) const
+  {
+    out.writeSharedString(value_);
+    out.writeSharedString(status_);
+    out.writeByte(isClose_ ? 1 : 0);
+    out.writeVarint(categories_.size());
+    for (auto& cat : categories_)
+      out.writeSharedString(cat);
+  }
+  //----< create PayLoad instance from its binary form >---------------
+  /*
+  * - Required by WriteAheadLog and Persist<PayLoad>::fromBinary
+  */
+  inline PayLoad PayLoad::deserialize(Binary::Reader& in)
+  {
+    PayLoad pl;
+    pl.value(in.readSharedString());
+    pl.status(in.readSharedString());
+    pl.isClose(in.readByte() != 0);
+    uint64_t numCategories = in.readVarint();
+    for (uint64_t i = 0; i < numCategories; ++i)
+      pl.categories().push_back(in.readSharedString());
+    return pl;
+  }
   /////////////////////////////////////////////////////////////////////
   // PayLoad display functions
 
@@ -0,0 +1,231 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// MappedSnapshot.h - use a binary snapshot's records in place         //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  This package defines two classes:
+*  - MappedFile maps a file into memory, read only.
+*  - MappedSnapshot<P> maps a version 3 binary snapshot, written by
+*    Persist<P>::toBinary, and is the RecordSource its records decode
+*    from.  open reads only the footer, string table, and record index.
+*    load adds each record to a DbCore<P> as a lazy DbElement<P> that
+*    holds its key, children, and offset, so loading costs the size of
+*    the index, not of the records.  A record's name, description,
+*    date, and payload are decoded from the mapped file the first time
+*    one of them is used.
+*  open verifies the string table and index, but reads no records, so
+*  opening costs the size of the index, not of the history.  Each
+*  record is checked against its own checksum when it is decoded, so a
+*  corrupt record fails the request that first uses it.
+*  The snapshot stays mapped while any element loaded from it is not
+*  decoded, so its file must not be replaced while in use.
+*
+*  Required Files:
+*  ---------------
+*  MappedSnapshot.h, Persist.h
+*  DbCore.h, BinaryCodec.h
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.1 : 17 Oct 2026
+*  - records are added with DbCore's load, not through dbStore()
+*  - decode verifies each record's checksum, written by version 3
+*    snapshots, instead of open reading every record
+*  ver 1.0 : 17 Oct 2026
+*  - first release
+*/
+
+#include <windows.h>
+#include <string>
+#include <memory>
+#include <exception>
+#include "Persist.h"
+
+namespace NoSqlDb
+{
+  /////////////////////////////////////////////////////////////////////
+  // MappedFile class
+  // - read only view of a whole file
+
+  class MappedFile
+  {
+  public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    const char* begin() const { return pBegin_; }
+    const char* end() const { return pBegin_ + size_; }
+    size_t size() const { return size_; }
+  private:
+    HANDLE hFile_ = INVALID_HANDLE_VALUE;
+    HANDLE hMap_ = NULL;
+    const char* pBegin_ = nullptr;
+    size_t size_ = 0;
+  };
+  //----< map file at path, returns false if it can't be mapped >------
+
+  inline bool MappedFile::open(const std::string& path)
+  {
+    close();
+    hFile_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    LARGE_INTEGER size;
+    if (hFile_ == INVALID_HANDLE_VALUE || !::GetFileSizeEx(hFile_, &size) || size.QuadPart == 0)
+    {
+      close();
+      return false;
+    }
+    hMap_ = ::CreateFileMappingA(hFile_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hMap_ != NULL)
+      pBegin_ = static_cast<const char*>(::MapViewOfFile(hMap_, FILE_MAP_READ, 0, 0, 0));
+    if (pBegin_ == nullptr)
+    {
+      close();
+      return false;
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    return true;
+  }
+  //----< unmap view and release handles >-----------------------------
+
+  inline void MappedFile::close()
+  {
+    if (pBegin_ != nullptr)
+      ::UnmapViewOfFile(pBegin_);
+    if (hMap_ != NULL)
+      ::CloseHandle(hMap_);
+    if (hFile_ != INVALID_HANDLE_VALUE)
+      ::CloseHandle(hFile_);
+    hFile_ = INVALID_HANDLE_VALUE;
+    hMap_ = NULL;
+    pBegin_ = nullptr;
+    size_ = 0;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // MappedSnapshot<P> class
+  // - records of a mapped binary snapshot, decoded on demand
+
+  template<typename P>
+  class MappedSnapshot : public RecordSource<P>, public std::enable_shared_from_this<MappedSnapshot<P>>
+  {
+  public:
+    static std::shared_ptr<MappedSnapshot<P>> open(const std::string& path);
+    size_t size() const { return count_; }
+    size_t load(DbCore<P>& db);
+    DbElement<P> decode(size_t offset) const override;
+  private:
+    MappedSnapshot() {}
+    bool openFile(const std::string& path);
+
+    MappedFile file_;
+    Binary::StringTable table_;
+    const char* pIndex_ = nullptr;
+    size_t count_ = 0;
+  };
+  //----< map snapshot at path and read its string table >-------------
+  /*
+  * - returns nullptr if path can't be mapped or isn't a version 3
+  *   binary snapshot, e.g., one written before records had checksums
+  * - throws if the snapshot's footer, table, or index are corrupt
+  */
+  template<typename P>
+  std::shared_ptr<MappedSnapshot<P>> MappedSnapshot<P>::open(const std::string& path)
+  {
+    std::shared_ptr<MappedSnapshot<P>> pSnap(new MappedSnapshot<P>);
+    if (!pSnap->openFile(path))
+      return nullptr;
+    return pSnap;
+  }
+  //----< check header and footer, then index the string table >-------
+
+  template<typename P>
+  bool MappedSnapshot<P>::openFile(const std::string& path)
+  {
+    if (!file_.open(path) || file_.size() < Persist<P>::HeaderSize || std::string(file_.begin(), 4) != "NSDB")
+      return false;
+    if (Binary::readFixed32(file_.begin() + 4) != Persist<P>::BinaryVersion)
+      return false;
+    if (file_.size() < Persist<P>::HeaderSize + Persist<P>::FooterSize)
+      throw std::exception("mapped snapshot truncated");
+    const char* pFooter = file_.end() - Persist<P>::FooterSize;
+    if (std::string(pFooter + 20, 4) != "NSDX")
+      throw std::exception("mapped snapshot has no index");
+    uint64_t tableOffset = Binary::readFixed64(pFooter);
+    uint64_t indexOffset = Binary::readFixed64(pFooter + 8);
+    uint64_t footerOffset = static_cast<uint64_t>(pFooter - file_.begin());
+    if (tableOffset < Persist<P>::HeaderSize || tableOffset > indexOffset || indexOffset > footerOffset)
+      throw std::exception("mapped snapshot index out of range");
+    const char* pTable = file_.begin() + tableOffset;
+    if (Binary::crc32(pTable, static_cast<size_t>(footerOffset - tableOffset)) != Binary::readFixed32(pFooter + 16))
+      throw std::exception("mapped snapshot index checksum failed");
+    table_.pEnd = file_.begin() + indexOffset;
+    Binary::Reader in(pTable, table_.pEnd);
+    uint64_t numStrings = in.readVarint();
+    table_.strings.reserve(static_cast<size_t>(numStrings));
+    for (uint64_t i = 0; i < numStrings; ++i)
+    {
+      table_.strings.push_back(in.next());
+      in.skipString();
+    }
+    pIndex_ = table_.pEnd;
+    in.range(pIndex_, pFooter);
+    count_ = static_cast<size_t>(in.readVarint());
+    return true;
+  }
+  //----< add every record to db as an element not yet decoded >-------
+  /*
+  * - replaces records db already holds with the same keys
+  * - returns the number of records added
+  */
+  template<typename P>
+  size_t MappedSnapshot<P>::load(DbCore<P>& db)
+  {
+    std::shared_ptr<const RecordSource<P>> pSource = this->shared_from_this();
+    Binary::Reader in(pIndex_, file_.end() - Persist<P>::FooterSize);
+    in.readVarint();
+    for (size_t i = 0; i < count_; ++i)
+    {
+      Key key = table_.get(in.readVarint());
+      uint64_t offset = in.readVarint();
+      if (offset >= file_.size())
+        throw std::exception("mapped snapshot record out of range");
+      Children children(static_cast<size_t>(in.readVarint()));
+      for (auto& child : children)
+        child = table_.get(in.readVarint());
+      db.load(key, DbElement<P>::lazy(pSource, static_cast<size_t>(offset), children));
+    }
+    return count_;
+  }
+  //----< decode record written at offset >----------------------------
+  /*
+  * - throws if the record doesn't match its checksum
+  */
+  template<typename P>
+  DbElement<P> MappedSnapshot<P>::decode(size_t offset) const
+  {
+    Binary::Reader in(file_.begin() + offset, file_.end(), table_);
+    uint64_t size = in.readVarint();
+    if (file_.end() - in.next() < 4 || size > static_cast<uint64_t>(file_.end() - in.next() - 4))
+      throw std::exception("mapped snapshot record truncated");
+    uint32_t crc = Binary::readFixed32(in.next());
+    in.range(in.next() + 4, in.next() + 4 + size);
+    if (Binary::crc32(in.next(), static_cast<size_t>(size)) != crc)
+      throw std::exception("mapped snapshot record checksum failed");
+    in.readSharedString();
+    return Binary::readElement<P>(in);
+  }
+}
@@ -27,6 +27,12 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.2 : 17 Oct 2026
+*  - test stub loads the binary snapshot lazily through MappedSnapshot
+*  - test stub checks that copies share decoding, and that a corrupt
+*    record is found when it is decoded, not when the snapshot is mapped
+*  ver 1.1 : 17 Oct 2026
+*  - test stub round trips the test database through a binary snapshot
 *  ver 1.0 : 12 Feb 2018
 *  - first release
 */
@@ -36,8 +42,12 @@
 #ifdef TEST_PERSIST
 
 #include "Persist.h"
+#include "MappedSnapshot.h"
 #include "../PayLoad/PayLoad.h"
 #include "../Utilities/StringUtilities/StringUtilities.h"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
 
 using namespace NoSqlDb;
 
@@ -109,6 +119,62 @@ int main()
   showDb(db);
   Utilities::putline();
   PayLoad::showDb(db);
+  Utilities::putline();
+
+  Utilities::title("after rebuilding db from binary snapshot");
+  std::ostringstream snapshot;
+  persist.toBinary(snapshot);
+  std::cout << "\n  snapshot holds " << snapshot.str().size() << " bytes, xml " << xml.size() << " bytes";
+  DbCore<PayLoad> restored;
+  Persist<PayLoad> persistRestored(restored);
+  std::istringstream in(snapshot.str());
+  persistRestored.fromBinary(in);
+  showDb(restored);
+  Utilities::putline();
+  PayLoad::showDb(restored);
+  Utilities::putline();
+
+  Utilities::title("after mapping binary snapshot, decoding records on use");
+  {
+    std::ofstream out("test.snap", std::ios::binary);
+    persist.toBinary(out);
+  }
+  DbCore<PayLoad> mapped;
+  MappedSnapshot<PayLoad>::open("test.snap")->load(mapped);
+  std::cout << "\n  record \"two\" decoded: " << std::boolalpha << mapped["two"].loaded();
+  std::cout << "\n  description of \"two\": " << mapped["two"].descrip();
+  std::cout << "\n  record \"two\" decoded: " << mapped["two"].loaded();
+  const DbElement<PayLoad>& original = mapped.find("three")->second;
+  DbElement<PayLoad> copy = original;
+  copy.descrip();
+  std::cout << "\n  decoding a copy of \"three\" decodes the original: " << original.loaded();
+  showDb(mapped);
+  Utilities::putline();
+  PayLoad::showDb(mapped);
+  mapped.clear();
+
+  Utilities::title("mapping a snapshot with a corrupt record");
+  std::string bytes = snapshot.str();
+  bytes[Persist<PayLoad>::HeaderSize + 6] ^= 0x5a;
+  {
+    std::ofstream out("test.snap", std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+  }
+  MappedSnapshot<PayLoad>::open("test.snap")->load(mapped);
+  std::cout << "\n  mapped " << mapped.size() << " records";
+  for (auto key : mapped.keys())
+  {
+    try
+    {
+      mapped[key].descrip();
+    }
+    catch (std::exception& ex)
+    {
+      std::cout << "\n  record \"" << key << "\": " << ex.what();
+    }
+  }
+  mapped.clear();
+  std::remove("test.snap");
 
   std::cout << "\n\n";
   return 0;
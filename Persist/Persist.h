@@ -1,6 +1,6 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
-// Persist.h - persist DbCore<P> to and from XML file                  //
+// Persist.h - persist DbCore<P> to and from XML or binary file        //
 //	                                                                   //
 // Author: Naga Rama Krishna, nrchalam@syr.edu                         //
 // Reference: Jim Fawcett                                              //
@@ -14,31 +14,72 @@
 *  -------------------
 *  This package defines a single Persist class that:
 *  - accepts a DbCore<P> instance when constructed
-*  - persists its database to an XML string
-*  - creates an instance of DbCore<P> from a persisted XML string
+*  - persists its database to an XML string, or streams it to a
+*    std::ostream with XmlWriter, without building an XmlDocument
+*  - creates an instance of DbCore<P> from a persisted XML string, or
+*    stream, reading one dbRecord at a time with XmlParser's events, so
+*    loading needs memory for one record, not for the whole document
+*  - streams its database to and from a binary snapshot, which holds
+*    every field, without building a DOM:
+*    - a header holds "NSDB" and the format's version
+*    - each record is its length, then its key and DbElement, encoded
+*      by BinaryCodec with names, categories, and child keys shared
+*    - a zero length ends the records, followed by the CRC-32 of all
+*      records and the record count
+*    - version 2 adds the shared string table, an index holding each
+*      record's key, offset, and child keys as table numbers, and a
+*      footer locating them, so MappedSnapshot can use records in place
+*    - version 3 writes each record's CRC-32 after its length, so a
+*      mapped record is checked when it is decoded
+*    P provides the serialize and deserialize hooks BinaryCodec uses.
+*  P provides fromXmlElement, and toXml(XmlWriter&), for XML.
 *  
 *  Required Files:
 *  ---------------
 *  Persist.h, Persist.cpp
 *  DbCore.h, DbCore.cpp
 *  Query.h, Query.cpp
-*  PayLoad.h
+*  PayLoad.h, BinaryCodec.h, XmlWriter.h
 *  XmlDocument.h, XmlDocument.cpp
 *  XmlElement.h, XmlElement.cpp
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.6 : 17 Oct 2026
+*  - records are loaded with DbCore's load, so indexes are rebuilt once
+*  - binary snapshots are version 3, with a checksum for each record
+*  - records not yet decoded are written from decodedCopy, which leaves
+*    them undecoded now that copies share their decoded fields
+*  ver 1.5 : 17 Oct 2026
+*  - toXml writes records with XmlWriter instead of building a DOM,
+*    added toXml(std::ostream&), output is unchanged except that
+*    markup characters in text are escaped
+*  ver 1.4 : 17 Oct 2026
+*  - fromXml streams records from XmlParser events instead of parsing
+*    the whole document, added fromXml(std::istream&)
+*  ver 1.3 : 17 Oct 2026
+*  - binary snapshots are version 2, with a string table, record index,
+*    and footer, toBinary leaves records that aren't decoded undecoded
+*  ver 1.2 : 17 Oct 2026
+*  - added toBinary and fromBinary
+*  ver 1.1 : 17 Oct 2026
+*  - toXml reads records with find, so it can save a shared snapshot
 *  ver 1.0 : 12 Feb 2018
 *  - first release
 */
 
 #include "../DbCore/DbCore.h"
+#include "../DbCore/BinaryCodec.h"
 #include "../Query/Query.h"
 #include "../DateTime/DateTime.h"
 #include "../XmlDocument/XmlDocument/XmlDocument.h"
 #include "../XmlDocument/XmlElement/XmlElement.h"
+#include "../XmlDocument/XmlParser/XmlParser.h"
+#include "../XmlDocument/XmlWriter/XmlWriter.h"
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <cstdint>
 
 namespace NoSqlDb
 {
@@ -64,12 +105,24 @@ namespace NoSqlDb
     Persist<P>& addShardKey(const Key& key);
     Persist<P>& removeShard();
     Xml toXml();
+    bool toXml(std::ostream& out);
     bool fromXml(const Xml& xml, bool augment = true);  // will clear and reload db if augment is false !!!
+    bool fromXml(std::istream& in, bool augment = true);  // same as above
+    bool toBinary(std::ostream& out);
+    bool fromBinary(std::istream& in, bool augment = true);  // same as fromXml
+    static const uint32_t BinaryVersion = 3;
+    static const size_t HeaderSize = 8;
+    static const size_t FooterSize = 24;
+    static const size_t ChunkSize = 64 * 1024;
+    static const size_t MaxRecordSize = 64 * 1024 * 1024;
   private:
     DbCore<P>& db_;
     Keys shardKeys_;
     bool containsKey(const Key& key);
-    void toXmlRecord(Sptr pDb, const Key& key, DbElement<P>& dbElem);
+    static void indexRecord(std::string& index, Binary::Writer& writer, const Key& key, size_t offset, const Children& children);
+    static std::string tableOf(Binary::Writer& writer);
+    void toXmlRecord(XmlWriter& out, const Key& key, const DbElement<P>& dbElem);
+    void fromXmlRecord(Sptr pRecord);
   };
   //----< constructor >------------------------------------------------
 
@@ -118,63 +171,71 @@ namespace NoSqlDb
   {
     shardKeys_.clear();
   }
-  //----< persist database record to XML string >----------------------
-
+  //----< write database record as XML >-------------------------------
+  /*
+  * - a record that isn't decoded yet is written from a copy, so
+  *   exporting doesn't decode every record
+  */
   template<typename P>
-  void Persist<P>::toXmlRecord(Sptr pDb, const Key& key, DbElement<P>& dbElem)
+  void Persist<P>::toXmlRecord(XmlWriter& out, const Key& key, const DbElement<P>& dbElem)
   {
-    Sptr pRecord = makeTaggedElement("dbRecord");
-    pDb->addChild(pRecord);
-    Sptr pKey = makeTaggedElement("key", key);
-    pRecord->addChild(pKey);
-
-    Sptr pValue = makeTaggedElement("value");
-    pRecord->addChild(pValue);
-    Sptr pName = makeTaggedElement("name", dbElem.name());
-    pValue->addChild(pName);
-    Sptr pDescrip = makeTaggedElement("description", dbElem.descrip());
-    pValue->addChild(pDescrip);
-
-    Sptr pChildren = makeTaggedElement("children");
-    pValue->addChild(pChildren);
-    for (auto child : dbElem.children())
+    const DbElement<P>* pElem = &dbElem;
+    DbElement<P> copy;
+    if (!dbElem.loaded())
     {
-      Sptr pChild = makeTaggedElement("child", child);
-      pChildren->addChild(pChild);
+      copy = dbElem.decodedCopy();
+      pElem = &copy;
     }
-
-    Sptr pPayLoad = dbElem.payLoad().toXmlElement();
-    pValue->addChild(pPayLoad);
+    out.start("dbRecord");
+    out.element("key", key);
+    out.start("value");
+    out.element("name", pElem->name());
+    out.element("description", pElem->descrip());
+    out.start("children");
+    for (auto& child : pElem->children())
+      out.element("child", child);
+    out.end();
+    pElem->payLoad().toXml(out);
+    out.end();
+    out.end();
   }
   //----< persist, possibly sharded, database to XML string >----------
+
+  template<typename P>
+  Xml Persist<P>::toXml()
+  {
+    std::ostringstream out;
+    toXml(out);
+    return out.str();
+  }
+  //----< stream, possibly sharded, database as XML >------------------
   /*
   * - database is sharded if the shardKeys collection is non-empty
+  * - memory used doesn't depend on the size of the database
   */
   template<typename P>
-  Xml Persist<P>::toXml()
+  bool Persist<P>::toXml(std::ostream& out)
   {
-    Sptr pDb = makeTaggedElement("db");
-    pDb->addAttrib("type", "fromQuery");
-    Sptr pDocElem = makeDocElement(pDb);
-    XmlDocument xDoc(pDocElem);
-
+    XmlWriter writer(out);
+    writer.start("db").attribute("type", "fromQuery");
     if (shardKeys_.size() > 0)
     {
       for (auto key : shardKeys_)
       {
-        DbElement<P> elem = db_[key];
-        toXmlRecord(pDb, key, elem);
+        typename DbCore<P>::iterator iter = db_.find(key);
+        if (iter != db_.end())
+          toXmlRecord(writer, key, iter->second);
       }
     }
     else
     {
-      for (auto item : db_)
+      for (auto& item : db_)
       {
-        toXmlRecord(pDb, item.first, item.second);
+        toXmlRecord(writer, item.first, item.second);
       }
     }
-    std::string xml = xDoc.toString();
-    return xml;
+    writer.end();
+    return out.good();
   }
   //----< retrieve database from XML string >--------------------------
   /*
@@ -183,48 +244,224 @@ namespace NoSqlDb
   template<typename P>
   bool Persist<P>::fromXml(const Xml& xml, bool augment)
   {
-    XmlProcessing::XmlDocument doc(xml);
+    std::istringstream in(xml);
+    return fromXml(in, augment);
+  }
+  //----< retrieve database from XML stream, one record at a time >----
+  /*
+  * - builds elements only for the dbRecord being read
+  * - throws if the XML is ill-formed
+  * - Will clear db and reload if augment is false
+  */
+  template<typename P>
+  bool Persist<P>::fromXml(std::istream& in, bool augment)
+  {
+    XmlParser parser(in);
     if(!augment)
-      db_.dbStore().clear();
-    std::vector<Sptr> pRecords = doc.descendents("dbRecord").select();
-    for (auto pRecord : pRecords)    {
-      Key key;
-      DbElement<P> elem;
-      P pl;
-		std::vector<Sptr> pChildren = pRecord->children();
-      for (auto pChild : pChildren)      {
-        if (pChild->tag() == "key")        
-          key = pChild->children()[0]->value();
-        else{
-          std::vector<Sptr> pValueChildren = pChild->children();
-          std::string valueOfTextNode;
-          for (auto pValueChild : pValueChildren){
-            std::string tag = pValueChild->tag();
-            if (pValueChild->children().size() > 0)
-              valueOfTextNode = pValueChild->children()[0]->value();
-            else
-              valueOfTextNode = "";
+      db_.clear();
+    std::vector<Sptr> open;
+    XmlParser::Event event;
+    while (parser.next(event))
+    {
+      if (event.type == XmlParser::startElement)
+      {
+        if (open.empty() && event.tag != "dbRecord")
+          continue;
+        Sptr pElem = makeTaggedElement(event.tag);
+        for (auto& item : event.attributes)
+          pElem->addAttrib(item.first, item.second);
+        if (!open.empty())
+          open.back()->addChild(pElem);
+        open.push_back(pElem);
+      }
+      else if (open.empty())
+        continue;
+      else if (event.type == XmlParser::text)
+        open.back()->addChild(makeTextElement(event.text));
+      else
+      {
+        Sptr pElem = open.back();
+        open.pop_back();
+        if (open.empty())
+          fromXmlRecord(pElem);
+      }
+    }
+    return true;
+  }
+  //----< add record held by dbRecord element to db >------------------
+
+  template<typename P>
+  void Persist<P>::fromXmlRecord(Sptr pRecord)
+  {
+    Key key;
+    DbElement<P> elem;
+    P pl;
+    std::vector<Sptr> pChildren = pRecord->children();
+    for (auto pChild : pChildren)      {
+      if (pChild->tag() == "key")        
+        key = pChild->children()[0]->value();
+      else{
+        std::vector<Sptr> pValueChildren = pChild->children();
+        std::string valueOfTextNode;
+        for (auto pValueChild : pValueChildren){
+          std::string tag = pValueChild->tag();
+          if (pValueChild->children().size() > 0)
+            valueOfTextNode = pValueChild->children()[0]->value();
+          else
+            valueOfTextNode = "";
 
-            if (tag == "name")           
-              elem.name(valueOfTextNode);
-            else if (tag == "description")
-              elem.descrip(valueOfTextNode);
-            else if (tag == "dateTime")
-              elem.dateTime(valueOfTextNode);
-            else if (tag == "children")            {
-              for (auto pChild : pValueChild->children())              {
-                valueOfTextNode = pChild->children()[0]->value();
-                elem.children().push_back(valueOfTextNode);
-              }
-            }            else if (tag == "payload")            {
-              pl = PayLoad::fromXmlElement(pValueChild);
-              elem.payLoad(pl);
+          if (tag == "name")           
+            elem.name(valueOfTextNode);
+          else if (tag == "description")
+            elem.descrip(valueOfTextNode);
+          else if (tag == "dateTime")
+            elem.dateTime(valueOfTextNode);
+          else if (tag == "children")            {
+            for (auto pChild : pValueChild->children())              {
+              valueOfTextNode = pChild->children()[0]->value();
+              elem.children().push_back(valueOfTextNode);
             }
+          }            else if (tag == "payload")            {
+            pl = P::fromXmlElement(pValueChild);
+            elem.payLoad(pl);
           }
         }
-        db_[key] = elem;
       }
+      db_.load(key, elem);
+    }
+  }
+  //----< stream, possibly sharded, database to binary snapshot >------
+  /*
+  * - records are written in chunks of about ChunkSize bytes
+  * - a record that isn't decoded yet is written from a copy, so saving
+  *   a snapshot doesn't decode every record it holds
+  */
+  template<typename P>
+  bool Persist<P>::toBinary(std::ostream& out)
+  {
+    std::string chunk("NSDB");
+    Binary::appendFixed32(chunk, BinaryVersion);
+    std::string record;
+    Binary::Writer writer(record, true);
+    std::string index;
+    size_t written = 0;
+    uint32_t crc = 0;
+    size_t count = 0;
+    Keys keys = shardKeys_.size() > 0 ? shardKeys_ : db_.keys();
+    for (auto& key : keys)
+    {
+      typename DbCore<P>::iterator iter = db_.find(key);
+      if (iter == db_.end())
+        continue;
+      record.clear();
+      writer.writeSharedString(key);
+      if (iter->second.loaded())
+        Binary::appendElement(writer, iter->second);
+      else
+        Binary::appendElement(writer, iter->second.decodedCopy());
+      crc = Binary::crc32(record.data(), record.size(), crc);
+      indexRecord(index, writer, key, written + chunk.size(), iter->second.children());
+      Binary::appendVarint(chunk, record.size());
+      Binary::appendFixed32(chunk, Binary::crc32(record.data(), record.size()));
+      chunk.append(record);
+      ++count;
+      if (chunk.size() >= ChunkSize)
+      {
+        out.write(chunk.data(), chunk.size());
+        written += chunk.size();
+        chunk.clear();
+      }
+    }
+    Binary::appendVarint(chunk, 0);
+    Binary::appendFixed32(chunk, crc);
+    Binary::appendVarint(chunk, count);
+    size_t tableOffset = written + chunk.size();
+    std::string table = tableOf(writer);
+    std::string indexCount;
+    Binary::appendVarint(indexCount, count);
+    crc = Binary::crc32(table.data(), table.size());
+    crc = Binary::crc32(indexCount.data(), indexCount.size(), crc);
+    crc = Binary::crc32(index.data(), index.size(), crc);
+    std::string footer;
+    Binary::appendFixed64(footer, tableOffset);
+    Binary::appendFixed64(footer, tableOffset + table.size());
+    Binary::appendFixed32(footer, crc);
+    footer.append("NSDX");
+    for (auto pPart : { &chunk, &table, &indexCount, &index, &footer })
+      out.write(pPart->data(), pPart->size());
+    return out.good();
+  }
+  //----< add key, record offset, and children to snapshot index >-----
+  /*
+  * - the key and children were just written, so all have numbers
+  */
+  template<typename P>
+  void Persist<P>::indexRecord(std::string& index, Binary::Writer& writer, const Key& key, size_t offset, const Children& children)
+  {
+    Binary::appendVarint(index, writer.sharedNumber(key));
+    Binary::appendVarint(index, offset);
+    Binary::appendVarint(index, children.size());
+    for (auto& child : children)
+      Binary::appendVarint(index, writer.sharedNumber(child));
+  }
+  //----< writer's shared strings, in the order they were numbered >---
+
+  template<typename P>
+  std::string Persist<P>::tableOf(Binary::Writer& writer)
+  {
+    std::string table;
+    Binary::appendVarint(table, writer.sharedCount());
+    for (size_t number = 1; number <= writer.sharedCount(); ++number)
+      Binary::appendString(table, writer.sharedString(number));
+    return table;
+  }
+  //----< stream database from binary snapshot >-----------------------
+  /*
+  * - returns false if in doesn't hold a binary snapshot
+  * - throws if the snapshot is truncated, corrupt, or a newer version
+  * - reads version 1 to 3 snapshots, ignoring the index, and checks
+  *   version 3's record checksums as well as the checksum of all records
+  * - Will clear db and reload if augment is false
+  */
+  template<typename P>
+  bool Persist<P>::fromBinary(std::istream& in, bool augment)
+  {
+    char header[8];
+    if (!in.read(header, 8) || std::string(header, 4) != "NSDB")
+      return false;
+    uint32_t version = Binary::readFixed32(header + 4);
+    if (version < 1 || version > BinaryVersion)
+      throw std::exception("unknown binary snapshot version");
+    if (!augment)
+      db_.clear();
+    std::string record;
+    Binary::Reader reader(nullptr, nullptr, true);
+    uint32_t crc = 0;
+    size_t count = 0;
+    while (true)
+    {
+      uint64_t size = Binary::readVarint(in);
+      if (size == 0)
+        break;
+      if (size > MaxRecordSize)
+        throw std::exception("binary snapshot record too large");
+      char recordCrc[4];
+      if (version >= 3 && !in.read(recordCrc, 4))
+        throw std::exception("binary snapshot truncated");
+      record.resize(static_cast<size_t>(size));
+      if (!in.read(&record[0], record.size()))
+        throw std::exception("binary snapshot truncated");
+      if (version >= 3 && Binary::readFixed32(recordCrc) != Binary::crc32(record.data(), record.size()))
+        throw std::exception("binary snapshot record checksum failed");
+      crc = Binary::crc32(record.data(), record.size(), crc);
+      reader.range(record.data(), record.data() + record.size());
+      Key key = reader.readSharedString();
+      db_.load(key, Binary::readElement<P>(reader));
+      ++count;
     }
+    char trailer[4];
+    if (!in.read(trailer, 4) || Binary::readFixed32(trailer) != crc || Binary::readVarint(in) != count)
+      throw std::exception("binary snapshot checksum failed");
     return true;
   }
 }
@@ -0,0 +1,268 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// Pattern.h - precompiled match patterns for query conditions         //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides two classes:
+* - RegexCache is a process-wide, thread-safe LRU cache of compiled
+*   std::regex objects keyed by pattern text, so queries issued by
+*   many clients with the same pattern compile it only once.
+* - Pattern is built once from a regular expression and then matched
+*   against many strings with std::regex_search semantics.  Patterns
+*   that reduce to a literal, like "Jim", "^Jim", "Cpp$", "^Jim$", or
+*   "This*" (which regex_search treats as containing "Thi"), are matched
+*   with string compares and never touch the regex engine.
+*
+* Required Files:
+* ---------------
+* Pattern.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 17th October 2026
+* - first release
+*/
+
+#include <string>
+#include <regex>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+namespace NoSqlDb
+{
+  /////////////////////////////////////////////////////////////////////
+  // RegexCache class
+  // - least recently used patterns are evicted when full
+
+  class RegexCache
+  {
+  public:
+    using RegexPtr = std::shared_ptr<const std::regex>;
+
+    static RegexCache& instance();
+    RegexPtr get(const std::string& pattern);
+    void capacity(size_t capacity);
+    size_t capacity();
+    size_t size();
+    void clear();
+  private:
+    RegexCache() {}
+    RegexCache(const RegexCache&) = delete;
+    RegexCache& operator=(const RegexCache&) = delete;
+    void trim();
+
+    using LruList = std::list<std::pair<std::string, RegexPtr>>;
+    std::mutex mtx_;
+    LruList lru_;
+    std::unordered_map<std::string, LruList::iterator> entries_;
+    size_t capacity_ = 64;
+  };
+  //----< return the single process-wide cache >-----------------------
+
+  inline RegexCache& RegexCache::instance()
+  {
+    static RegexCache cache;
+    return cache;
+  }
+  //----< return compiled regex for pattern, compiling on a miss >-----
+  /*
+  *  - compiles outside the lock, so a slow compile does not block
+  *    lookups of other patterns
+  *  - throws std::regex_error if pattern is not a valid regex
+  */
+  inline RegexCache::RegexPtr RegexCache::get(const std::string& pattern)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto iter = entries_.find(pattern);
+      if (iter != entries_.end())
+      {
+        lru_.splice(lru_.begin(), lru_, iter->second);
+        return iter->second->second;
+      }
+    }
+    RegexPtr pRegex = std::make_shared<const std::regex>(pattern);
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = entries_.find(pattern);
+    if (iter != entries_.end())
+      return iter->second->second;
+    lru_.emplace_front(pattern, pRegex);
+    entries_[pattern] = lru_.begin();
+    trim();
+    return pRegex;
+  }
+  //----< set maximum number of cached patterns >----------------------
+
+  inline void RegexCache::capacity(size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    capacity_ = capacity;
+    trim();
+  }
+  //----< return maximum number of cached patterns >-------------------
+
+  inline size_t RegexCache::capacity()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return capacity_;
+  }
+  //----< return number of cached patterns >---------------------------
+
+  inline size_t RegexCache::size()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return lru_.size();
+  }
+  //----< drop all cached patterns >-----------------------------------
+
+  inline void RegexCache::clear()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    lru_.clear();
+    entries_.clear();
+  }
+  //----< evict least recently used patterns, caller holds lock >------
+
+  inline void RegexCache::trim()
+  {
+    while (lru_.size() > capacity_)
+    {
+      entries_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  // Pattern class
+  // - cheap to copy, compiled regexes are shared
+
+  class Pattern
+  {
+  public:
+    enum Kind { any, contains, prefix, suffix, exact, regex, invalid };
+
+    Pattern() {}
+    explicit Pattern(const std::string& text);
+    Kind kind() const { return kind_; }
+    const std::string& text() const { return text_; }
+    const std::string& literal() const { return literal_; }
+    bool match(const std::string& str) const;
+  private:
+    static bool isMeta(char ch);
+    static bool reduce(std::string text, std::string& literal, Kind& kind);
+
+    Kind kind_ = any;
+    std::string text_;
+    std::string literal_;
+    RegexCache::RegexPtr pRegex_;
+    std::regex_constants::error_type error_ = std::regex_constants::error_type();
+  };
+  //----< is ch special in an ECMAScript regex? >----------------------
+
+  inline bool Pattern::isMeta(char ch)
+  {
+    return std::string(".[]{}()*+?|^$\\").find(ch) != std::string::npos;
+  }
+  //----< reduce regex to a literal string compare, if possible >------
+  /*
+  *  - strips "^" and "$" anchors
+  *  - with regex_search a trailing "x*", "x?", ".*", or ".?" never
+  *    changes whether a match exists unless the pattern ends with "$",
+  *    so those are dropped
+  *  - anything else left must be plain characters
+  */
+  inline bool Pattern::reduce(std::string text, std::string& literal, Kind& kind)
+  {
+    bool atStart = text.size() > 0 && text[0] == '^';
+    if (atStart)
+      text.erase(0, 1);
+    size_t n = text.size();
+    bool atEnd = n > 0 && text[n - 1] == '$' && (n < 2 || text[n - 2] != '\\');
+    if (atEnd)
+      text.erase(n - 1);
+    while (!atEnd && text.size() >= 2)
+    {
+      n = text.size();
+      char last = text[n - 1];
+      char repeated = text[n - 2];
+      if (last != '*' && last != '?')
+        break;
+      if (isMeta(repeated) && repeated != '.')
+        break;
+      if (n >= 3 && text[n - 3] == '\\')
+        break;
+      text.erase(n - 2);
+    }
+    for (char ch : text)
+    {
+      if (isMeta(ch))
+        return false;
+    }
+    literal = text;
+    if (atStart && atEnd)
+      kind = exact;
+    else if (atStart)
+      kind = prefix;
+    else if (atEnd)
+      kind = suffix;
+    else
+      kind = contains;
+    return true;
+  }
+  //----< build pattern, compiling regex only when needed >------------
+  /*
+  *  - an invalid regex does not throw here, but on every match, as
+  *    constructing a std::regex during the match used to
+  */
+  inline Pattern::Pattern(const std::string& text) : text_(text)
+  {
+    if (text == "")
+      return;
+    if (reduce(text, literal_, kind_))
+      return;
+    try
+    {
+      pRegex_ = RegexCache::instance().get(text);
+      kind_ = regex;
+    }
+    catch (std::regex_error& ex)
+    {
+      kind_ = invalid;
+      error_ = ex.code();
+    }
+  }
+  //----< does str contain a match for the pattern? >------------------
+
+  inline bool Pattern::match(const std::string& str) const
+  {
+    size_t size = literal_.size();
+    switch (kind_)
+    {
+    case any:
+      return true;
+    case contains:
+      return str.find(literal_) != std::string::npos;
+    case prefix:
+      return str.compare(0, size, literal_) == 0;
+    case suffix:
+      return str.size() >= size && str.compare(str.size() - size, size, literal_) == 0;
+    case exact:
+      return str == literal_;
+    case regex:
+      return std::regex_search(str, *pRegex_);
+    default:
+      throw std::regex_error(error_);
+    }
+  }
+}
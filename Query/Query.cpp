@@ -26,6 +26,14 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.1 : 17th October 2026
+*  - added category and status conditions
+*  - select(Conditions) plans index lookups before falling back to a scan
+*  - name and description patterns compiled once and shared through RegexCache
+*  - added parallel, partitioned scans
+*  - query_and and query_not demonstrated with requirement #7
+*  - demonstrated cursors and paged selects
+*  - demonstrated resuming after the last key of a page while records are added
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th Feb 2018
@@ -37,6 +45,7 @@
 #ifdef TEST_QUERY
 
 #include <chrono>
+#include <algorithm>
 #include "Query.h"
 #include "../PayLoad/PayLoad.h"
 #include "../Utilities/StringUtilities/StringUtilities.h"
@@ -179,7 +188,17 @@ bool testR7(DbCore<PayLoad>& db)
   Utilities::title("q2 = q2 and q1");
   q2.select(conds1).show();
   Utilities::putline();
-  return true;
+
+  Utilities::title("q3 = TAs and not q1, using set operators");
+  Query<PayLoad> q3(db);
+  q3.select(conds2).query_or(q1).query_not(q1).show();
+  Utilities::putline();
+  size_t notCount = q3.keys().size();
+
+  Utilities::title("q3 = q3 and q1");
+  q3.query_and(q1).show();
+  Utilities::putline();
+  return notCount > 0 && q3.keys().size() == 0;
 }
 bool testR9(DbCore<PayLoad>& db)
 {
@@ -205,14 +224,14 @@ bool testR9(DbCore<PayLoad>& db)
   std::string category = "thirdCategory";
   std::cout << "\n  select on payload categories for \"" << category << "\"\n";
 
-  auto hasCategory = [&category](DbElement<PayLoad>& elem) {
+  auto hasCategory = [&category](const DbElement<PayLoad>& elem) {
     return (elem.payLoad()).hasCategory(category);
   };
 
   q1.select(hasCategory).show();
 
   std::string value = "Test Payload #1";
-  auto hasValue = [&value](DbElement<PayLoad>& elem) {
+  auto hasValue = [&value](const DbElement<PayLoad>& elem) {
     return (elem.payLoad()).value() == value;
   };
   Utilities::putline();
@@ -223,6 +242,134 @@ bool testR9(DbCore<PayLoad>& db)
   return true;
 }
 
+//----< demo indexed queries >-----------------------------------------
+
+bool testIndexes(DbCore<PayLoad>& db)
+{
+  Utilities::title("Demonstrating indexed queries");
+  db.useIndexes(true);
+
+  std::cout << "\n  select on exact name \"^Ammar$\" and category \"firstCategory\"\n";
+  Conditions<PayLoad> conds1;
+  conds1.name("^Ammar$");
+  conds1.category("firstCategory");
+  Query<PayLoad> q1(db);
+  q1.select(conds1).show();
+  if (q1.keys().size() != 1)
+    return false;
+  Utilities::putline();
+
+  std::cout << "\n  renaming \"Salman\" to \"Jimmy\" and selecting on name prefix \"^Ji\"\n";
+  db["Salman"].name("Jimmy");
+  Conditions<PayLoad> conds2;
+  conds2.name("^Ji");
+  q1.select(conds2).show();
+  Utilities::putline();
+  bool renamed = q1.keys().size() == 2;
+
+  std::cout << "\n  renaming \"Jimmy\" back through a reference kept across that query\n";
+  DbElement<PayLoad>& kept = db["Salman"];
+  q1.select(conds2);
+  kept.name("Salman");
+  q1.select(conds2).show();
+  Utilities::putline();
+  db.useIndexes(false);
+  return renamed && q1.keys().size() == 1;
+}
+//----< demo literal patterns agree with the regex engine >------------
+
+bool testPatterns()
+{
+  Utilities::title("Demonstrating precompiled patterns");
+  std::vector<std::string> texts{ "", "This is a file", "Thin", "Th", "is This", "a.b", "Jim" };
+  std::vector<std::string> regExps{ "This*", "^This*", "file$", "^Jim$", "a\\.b", "J.m", "Th?" };
+  bool ok = true;
+  for (auto regExp : regExps)
+  {
+    Pattern pattern(regExp);
+    std::regex re(regExp);
+    std::cout << "\n  " << std::setw(8) << std::left << regExp << " kind = " << pattern.kind()
+      << ", literal = \"" << pattern.literal() << "\"";
+    for (auto text : texts)
+      ok = ok && (pattern.match(text) == std::regex_search(text, re));
+  }
+  std::cout << "\n  patterns " << (ok ? "agree" : "do not agree") << " with std::regex_search";
+  Utilities::putline();
+  return ok;
+}
+//----< demo parallel scans return the same keys as sequential >-------
+
+bool testParallel()
+{
+  Utilities::title("Demonstrating parallel queries");
+  DbCore<PayLoad> db;
+  for (size_t i = 0; i < 5000; ++i)
+  {
+    DbElement<PayLoad> elem;
+    elem.name(i % 3 == 0 ? "Jim" : "Ammar");
+    elem.descrip("record " + std::to_string(i));
+    db.addRecord("key" + std::to_string(i), elem);
+  }
+  Conditions<PayLoad> conds;
+  conds.name("Jim");
+  conds.description("7$");
+
+  Query<PayLoad> q1(db);
+  Keys sequential = q1.select(conds).keys();
+  Query<PayLoad> q2(db);
+  Keys parallel = q2.parallel(4).select(conds).keys();
+  Keys again = q2.parallel(8).select(conds).keys();
+
+  std::cout << "\n  sequential scan found " << sequential.size() << " keys";
+  std::cout << "\n  parallel scan found " << parallel.size() << " keys";
+  bool sameOrder = parallel == again;
+  std::sort(sequential.begin(), sequential.end());
+  std::sort(parallel.begin(), parallel.end());
+  std::cout << "\n  parallel order " << (sameOrder ? "does not depend" : "depends") << " on partition count";
+  Utilities::putline();
+  return sameOrder && sequential == parallel;
+}
+//----< demo cursors and paged selects >-------------------------------
+
+bool testPaging(DbCore<PayLoad>& db)
+{
+  Utilities::title("Demonstrating cursors and paging");
+  Conditions<PayLoad> conds;
+  conds.description("TA");
+
+  Query<PayLoad> all(db);
+  Keys allKeys = all.select(conds).keys();
+
+  std::cout << "\n  walking a cursor over TAs, stopping after two";
+  Query<PayLoad> q1(db);
+  Cursor<PayLoad> cursor = q1.limit(2).cursor(conds);
+  Keys firstPage;
+  while (cursor.next())
+  {
+    std::cout << "\n    " << cursor.key() << " : " << cursor.element().name();
+    firstPage.push_back(cursor.key());
+  }
+
+  std::cout << "\n\n  second page of TAs, offset 2 and limit 2\n";
+  Query<PayLoad> q2(db);
+  q2.offset(2).limit(2).select(conds).show();
+  Keys secondPage = q2.keys();
+  Utilities::putline();
+
+  std::cout << "\n\n  adding a TA whose key sorts first, then resuming after the first page\n";
+  db.addRecord("Aaa", makeElement<PayLoad>("Aaa", "TA for CSE687"));
+  Query<PayLoad> q3(db);
+  q3.after(firstPage.back()).limit(2).select(conds).show();
+  Keys resumed = q3.keys();
+  db.removeRecord("Aaa");
+  Utilities::putline();
+
+  Keys pages = firstPage;
+  pages.insert(pages.end(), secondPage.begin(), secondPage.end());
+  allKeys.resize((std::min)(allKeys.size(), size_t(4)));
+  return firstPage.size() == 2 && pages == allKeys && resumed == secondPage;
+}
+
 int main()
 {
   Utilities::Title("Demonstrating Query Package");
@@ -235,6 +382,10 @@ int main()
   testR6(db);
   testR7(db);
   testR9(db);
+  testIndexes(db);
+  testPatterns();
+  testParallel();
+  testPaging(db);
 
   std::cout << "\n\n";
   return 0;
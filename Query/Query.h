@@ -18,15 +18,44 @@
 *	to retrieve from database for particular key
 * -	Query class provides functionality to mention SELECT, FROM, WHERE part of the query
 *	inorder to retrieve data from database. Also runs the specific query against specific database
+* - When the database keeps secondary indexes, turned on with DbCore's
+*   useIndexes(true), select(Conditions) uses the index for an exact or
+*   prefix name ("^name$", "^prefix"), a category, a status, or a dateTime
+*   interval, and only scans when none of those is set.  Without them,
+*   select always scans.
+* - Name and description patterns are compiled once, when they are set,
+*   see Pattern.h.
+* - Query::parallel(n) splits scans of large dbs into n key ranges
+*   that are evaluated on the shared ThreadPool.
+* - query_or, query_and, and query_not combine the keys of two queries
+*   using hashed key sets, keeping this query's key order.
+* - Cursor yields matching records one at a time, in key order, with
+*   optional offset and limit, so callers that only want the first page
+*   of results stop scanning as soon as they have it.  after(key) starts
+*   the next page after the last key of the previous one, so records
+*   added or removed between requests don't shift later pages.
+*   Query::cursor(conds) builds one, and Query::after/offset/limit apply
+*   the same paging to select.
 *
 *
 * Build Process:
 * ---------------
-* - Required files: QueryUtilites.h,QueryUtilites.cpp, DbCore.h, DbCore.cpp, DateTime.h, DateTime.cpp, Utilities.h, Utilities.cpp
+* - Required files: QueryUtilites.h,QueryUtilites.cpp, Pattern.h, ThreadPool.h, DbCore.h, DbCore.cpp, DateTime.h, DateTime.cpp, Utilities.h, Utilities.cpp
 * - Compiler command: devenv NoSqlDb.sln /rebuild debug
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.2 : 17th October 2026
+*  - conditions, predicates, and cursors see db elements as const
+*  - parallel scans split the db by rank instead of by hash bucket
+*  - added after(key), to page by the last key seen instead of by offset
+*  ver 2.1 : 17th October 2026
+*  - added category and status conditions
+*  - select(Conditions) plans index lookups before falling back to a scan
+*  - name and description patterns compiled once and shared through RegexCache
+*  - added parallel, partitioned scans
+*  - query_or uses a hashed key set, added query_and and query_not
+*  - added Cursor, offset, and limit; query keys are collected on first use
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th Feb 2018
@@ -34,9 +63,13 @@
 */
 #include "../DbCore/Definitions.h"
 #include "../DbCore/DbCore.h"
+#include "Pattern.h"
+#include "../Utilities/ThreadPool/ThreadPool.h"
 #include <vector>
 #include <string>
 #include <regex>
+#include <unordered_set>
+#include <functional>
 
 namespace NoSqlDb
 {
@@ -54,18 +87,30 @@ namespace NoSqlDb
     using RegExp = const std::string&;
 
     Conditions() = default;
-    void value(DbElement<P>& elem) { pDbElem_ = &elem; } // set pointer to element used during query
+    void value(const DbElement<P>& elem) { pDbElem_ = &elem; } // set pointer to element used during query
 
     bool match();
-    void name(RegExp regExp) { nameRegExp_ = regExp; }    
+    void name(RegExp regExp) { nameRegExp_ = regExp; namePattern_ = Pattern(regExp); }
     bool matchName();
-    void description(RegExp regExp) { descriptionRegExp_ = regExp; }
+    void description(RegExp regExp) { descriptionRegExp_ = regExp; descriptionPattern_ = Pattern(regExp); }
     bool matchDescription();
     void lowerBound(const DateTime& lower) { lowerBound_ = lower; }
     void upperBound(const DateTime& upper = DateTime.now()) { upperBound_ = upper; }
     bool matchDateTimeInterval();
     void children(Keys keys) { keys_ = keys; }
     bool matchChildren();
+    void category(const std::string& category) { category_ = category; }
+    bool matchCategory();
+    void status(const std::string& status) { status_ = status; }
+    bool matchStatus();
+
+    // accessors used by Query to plan index lookups
+
+    std::string nameRegExp() { return nameRegExp_; }
+    const Pattern& namePattern() { return namePattern_; }
+    std::string category() { return category_; }
+    std::string status() { return status_; }
+    bool timeInterval(DateTime& lower, DateTime& upper);
 
     ///////////////////////////////////////////////////////////////
     // Not currently using the two functions, below.
@@ -81,12 +126,16 @@ namespace NoSqlDb
   private:
     // DbElement<P> is referenced through pointer, not C++ reference type,
     // so the element can be changed at any time.
-    DbElement<P>* pDbElem_ = nullptr;
+    const DbElement<P>* pDbElem_ = nullptr;
     std::string nameRegExp_ = "";
     std::string descriptionRegExp_ = "";
+    Pattern namePattern_;
+    Pattern descriptionPattern_;
     DateTime lowerBound_ = DateTime().now();
     DateTime upperBound_ = DateTime().now();
     Keys keys_;
+    std::string category_ = "";
+    std::string status_ = "";
     ///////////////////////////////////////////////////////////////
     // Not currently used, but may later.
     // template<typename CallObj>
@@ -99,7 +148,8 @@ namespace NoSqlDb
   {
     try
     {
-      return matchName() && matchDescription() && matchChildren() && matchDateTimeInterval();
+      return matchName() && matchDescription() && matchChildren() && matchDateTimeInterval()
+        && matchCategory() && matchStatus();
     }
     catch (std::exception& ex)
     {
@@ -114,8 +164,7 @@ namespace NoSqlDb
   {
     if (nameRegExp_ == "")
       return true;
-    std::regex re(nameRegExp_);
-    return std::regex_search(pDbElem_->name(), re);
+    return namePattern_.match(pDbElem_->name());
   }
   /*----< test metadata for description match >----------------------*/
 
@@ -124,9 +173,7 @@ namespace NoSqlDb
   {
     if (descriptionRegExp_ == "")
       return true;
-    std::regex re(descriptionRegExp_);
-    std::string desc = pDbElem_->descrip();
-    return std::regex_search(desc, re);
+    return descriptionPattern_.match(pDbElem_->descrip());
   }
   /*----< test metadata for time interval match >--------------------*/
 
@@ -147,8 +194,9 @@ namespace NoSqlDb
   {
 	if (keys_.size() == 0)
       return true;
-	Keys::iterator start = pDbElem_->children().begin();
-    Keys::iterator end = pDbElem_->children().end();
+	Children children = pDbElem_->children();
+    Keys::iterator start = children.begin();
+    Keys::iterator end = children.end();
     for (Key key : keys_)
     {
       if (std::find(start, end, key) == end)
@@ -156,7 +204,161 @@ namespace NoSqlDb
     }
     return true;
   }
+  /*----< test payload for category match >--------------------------*/
+
+  template<typename P>
+  bool Conditions<P>::matchCategory()
+  {
+    if (category_ == "")
+      return true;
+    Keys categories = IndexTraits<P>::categories(pDbElem_->payLoad());
+    return std::find(categories.begin(), categories.end(), category_) != categories.end();
+  }
+  /*----< test payload for status match >----------------------------*/
+
+  template<typename P>
+  bool Conditions<P>::matchStatus()
+  {
+    if (status_ == "")
+      return true;
+    return IndexTraits<P>::status(pDbElem_->payLoad()) == status_;
+  }
+  /*----< return time interval, if one was set >---------------------*/
+
+  template<typename P>
+  bool Conditions<P>::timeInterval(DateTime& lower, DateTime& upper)
+  {
+    if (lowerBound_ == upperBound_)
+      return false;
+    lower = lowerBound_;
+    upper = upperBound_;
+    return true;
+  }
   
+  /////////////////////////////////////////////////////////////////////
+  // Cursor class
+  // - lazily yields keys of db elements that satisfy a predicate
+  // - walks the whole db, or a sorted candidate key list from an index,
+  //   so keys are always yielded in order
+  // - like any iterator into the db, it is invalidated by adding or
+  //   removing records while it is in use
+
+  template<typename P>
+  class Cursor
+  {
+  public:
+    using Pred = std::function<bool(const DbElement<P>&)>;
+    static const size_t noLimit = static_cast<size_t>(-1);
+
+    Cursor(DbCore<P>& db, Pred pred);
+    Cursor(DbCore<P>& db, Pred pred, const Keys& candidates);
+    Cursor& after(const Key& key);
+    Cursor& offset(size_t count) { skip_ = count; return *this; }
+    Cursor& limit(size_t count) { limit_ = count; return *this; }
+    bool next();
+    const Key& key() { return key_; }
+    const DbElement<P>& element() { return *pElem_; }
+    Keys keys();
+  private:
+    bool advance();
+    DbCore<P>& db_;
+    Pred pred_;
+    bool useCandidates_ = false;
+    Keys candidates_;
+    size_t candidate_ = 0;
+    typename DbCore<P>::iterator iter_;
+    size_t skip_ = 0;
+    size_t limit_ = noLimit;
+    size_t count_ = 0;
+    Key key_;
+    const DbElement<P>* pElem_ = nullptr;
+  };
+  /*----< cursor over all db elements >------------------------------*/
+
+  template<typename P>
+  Cursor<P>::Cursor(DbCore<P>& db, Pred pred)
+    : db_(db), pred_(pred), iter_(db.begin()) {}
+
+  /*----< cursor over elements with candidate keys >-----------------*/
+
+  template<typename P>
+  Cursor<P>::Cursor(DbCore<P>& db, Pred pred, const Keys& candidates)
+    : db_(db), pred_(pred), useCandidates_(true), candidates_(candidates), iter_(db.end()) {}
+
+  /*----< start after key, which need not be in the db >-------------*/
+
+  template<typename P>
+  Cursor<P>& Cursor<P>::after(const Key& key)
+  {
+    if (useCandidates_)
+    {
+      candidate_ = std::upper_bound(candidates_.begin(), candidates_.end(), key) - candidates_.begin();
+      return *this;
+    }
+    iter_ = db_.lower_bound(key);
+    if (iter_ != db_.end() && iter_->first == key)
+      ++iter_;
+    return *this;
+  }
+  /*----< move to next match, skipping offset, returns false at end >*/
+
+  template<typename P>
+  bool Cursor<P>::next()
+  {
+    if (count_ >= limit_)
+      return false;
+    for (; skip_ > 0; --skip_)
+    {
+      if (!advance())
+        return false;
+    }
+    if (!advance())
+      return false;
+    ++count_;
+    return true;
+  }
+  /*----< move to next element satisfying pred >---------------------*/
+
+  template<typename P>
+  bool Cursor<P>::advance()
+  {
+    while (true)
+    {
+      if (useCandidates_)
+      {
+        if (candidate_ == candidates_.size())
+          return false;
+        iter_ = db_.find(candidates_[candidate_++]);
+        if (iter_ == db_.end())
+          continue;
+      }
+      else
+      {
+        if (pElem_ != nullptr)
+          ++iter_;
+        if (iter_ == db_.end())
+          return false;
+        pElem_ = &iter_->second;
+      }
+      if (pred_(iter_->second))
+      {
+        key_ = iter_->first;
+        pElem_ = &iter_->second;
+        return true;
+      }
+    }
+  }
+  /*----< collect keys of all remaining matches >--------------------*/
+
+  template<typename P>
+  Keys Cursor<P>::keys()
+  {
+    Keys found;
+    while (next())
+      found.push_back(key_);
+    return found;
+  }
+
   /////////////////////////////////////////////////////////////////////
   // Query class
 
@@ -164,7 +366,7 @@ namespace NoSqlDb
   class Query
   {
   public:
-    Query(DbCore<P>& db) : db_(db) { keys_ = db_.keys(); }
+    Query(DbCore<P>& db) : db_(db) {}
     
     static void identify(std::ostream& out = std::cout);
 
@@ -173,17 +375,67 @@ namespace NoSqlDb
     Query& select(CallObj callObj);
 
     Query& query_or(Query<P>& q);
+    Query& query_and(Query<P>& q);
+    Query& query_not(Query<P>& q);
+
+    Query& from(const Keys& keys) { keys_ = keys; allKeys_ = false; return *this; }
 
-    Query& from(const Keys& keys) { keys_ = keys; return *this; }
+    // paging
+    // - select keeps only matches after the first offset, up to limit,
+    //   and stops scanning once it has them
+    // - after(key) keeps only matches whose keys follow key, so passing
+    //   the last key of one page gets the next, however the db changed
+    // - cursor(conds) returns the same matches one at a time
+
+    Query& after(const Key& key) { after_ = key; resume_ = true; return *this; }
+    Query& offset(size_t count) { offset_ = count; return *this; }
+    Query& limit(size_t count = Cursor<P>::noLimit) { limit_ = count; return *this; }
+    Cursor<P> cursor(Conditions<P>& conds);
+
+    // parallel scans
+    // - dbs with at least minSize records are split into partitions
+    //   key ranges, each scanned on ThreadPool::shared()
+    // - each partition gets its own copy of the Conditions or CallObj,
+    //   so a CallObj must be safe to copy and to call concurrently
+    // - partition results are merged in key order, so the result
+    //   order does not depend on thread timing
+
+    Query& parallel(size_t partitions = Utilities::ThreadPool::defaultThreads(), size_t minSize = 1024);
+    Query& sequential() { partitions_ = 1; return *this; }
 
     void show(std::ostream& out = std::cout);
 
-    Keys& keys() { return keys_; }
+    Keys& keys();
 
   private:
+    bool plan(Conditions<P>& conds, Keys& candidates);
+    bool paging() { return resume_ || offset_ > 0 || limit_ != Cursor<P>::noLimit; }
+    Cursor<P> page(Cursor<P> cursor);
+    template<typename Pred>
+    Keys scan(Pred pred);
+    void result(const Keys& keys) { keys_ = keys; allKeys_ = false; }
     DbCore<P>& db_;
     Keys keys_;
+    bool allKeys_ = true;
+    size_t partitions_ = 1;
+    size_t minParallelSize_ = 1024;
+    bool resume_ = false;
+    Key after_;
+    size_t offset_ = 0;
+    size_t limit_ = Cursor<P>::noLimit;
   };
+  /*----< return query keys, all db keys if nothing selected yet >---*/
+
+  template<typename P>
+  Keys& Query<P>::keys()
+  {
+    if (allKeys_)
+    {
+      keys_ = db_.keys();
+      allKeys_ = false;
+    }
+    return keys_;
+  }
   //----< show file name >---------------------------------------------
 
   template<typename P>
@@ -196,16 +448,91 @@ namespace NoSqlDb
   template<typename P>
   Query<P>& Query<P>::select(Conditions<P>& conds)
   {
+    if (paging())
+    {
+      result(cursor(conds).keys());
+      return *this;
+    }
     Keys newKeys;
-    for (auto item : db_)
+    Keys candidates;
+    if (plan(conds, candidates))
     {
-      conds.value(item.second);
-      if (conds.match())
-        newKeys.push_back(item.first);
+      for (auto key : candidates)
+      {
+        typename DbCore<P>::iterator iter = db_.find(key);
+        if (iter == db_.end())
+          continue;
+        conds.value(iter->second);
+        if (conds.match())
+          newKeys.push_back(key);
+      }
     }
-    keys_ = newKeys;
+    else
+    {
+      newKeys = scan([conds](const DbElement<P>& elem) mutable {
+        conds.value(elem);
+        return conds.match();
+      });
+    }
+    result(newKeys);
     return *this;
   }
+  /*----< lazily yield keys matching conds, honoring offset and limit >*/
+
+  template<typename P>
+  Cursor<P> Query<P>::cursor(Conditions<P>& conds)
+  {
+    auto pred = [conds](const DbElement<P>& elem) mutable {
+      conds.value(elem);
+      return conds.match();
+    };
+    Keys candidates;
+    if (plan(conds, candidates))
+      return page(Cursor<P>(db_, pred, candidates));
+    return page(Cursor<P>(db_, pred));
+  }
+  /*----< apply this query's paging to cursor >----------------------*/
+
+  template<typename P>
+  Cursor<P> Query<P>::page(Cursor<P> cursor)
+  {
+    if (resume_)
+      cursor.after(after_);
+    return cursor.offset(offset_).limit(limit_);
+  }
+  /*----< choose smallest candidate key set the indexes provide >----*/
+  /*
+  *  - returns false if db has no indexes or conds has no indexable
+  *    condition, in which case select must scan the db
+  *  - candidates are checked against all of conds by select
+  *  - index lookups return sorted keys, as Cursor::after requires
+  */
+  template<typename P>
+  bool Query<P>::plan(Conditions<P>& conds, Keys& candidates)
+  {
+    if (!db_.usingIndexes())
+      return false;
+    DbIndex<P>& index = db_.indexes();
+    bool planned = false;
+    auto consider = [&](const Keys& keys) {
+      if (!planned || keys.size() < candidates.size())
+        candidates = keys;
+      planned = true;
+    };
+    const Pattern& name = conds.namePattern();
+    if (name.kind() == Pattern::exact)
+      consider(index.name(name.literal()));
+    else if (name.kind() == Pattern::prefix && name.literal() != "")
+      consider(index.namePrefix(name.literal()));
+    if (conds.category() != "")
+      consider(index.category(conds.category()));
+    if (conds.status() != "")
+      consider(index.status(conds.status()));
+    DateTime lower, upper;
+    if (conds.timeInterval(lower, upper))
+      consider(index.dateTime(lower, upper));
+    return planned;
+  }
   /*----< supports application defined queries for payload >---------*/
   /*
   *  - CallObj is defined by the application to return results from
@@ -215,42 +542,135 @@ namespace NoSqlDb
   template<typename CallObj>
   Query<P>& Query<P>::select(CallObj callObj)
   {
-    Keys newKeys;
-    for (auto item : db_)
+    if (paging())
+      result(page(Cursor<P>(db_, callObj)).keys());
+    else
+      result(scan(callObj));
+    return *this;
+  }
+  /*----< set number of partitions used to scan large dbs >---------*/
+  /*
+  *  - partitions of 0 or 1 means scan sequentially
+  */
+  template<typename P>
+  Query<P>& Query<P>::parallel(size_t partitions, size_t minSize)
+  {
+    partitions_ = partitions;
+    minParallelSize_ = minSize;
+    return *this;
+  }
+  /*----< keys of all db elements for which pred returns true >------*/
+  /*
+  *  - small dbs, and all dbs in sequential mode, are scanned on the
+  *    calling thread
+  *  - otherwise records are split by rank into partitions_ ranges, the
+  *    calling thread scans the first and pool threads the rest
+  */
+  template<typename P>
+  template<typename Pred>
+  Keys Query<P>::scan(Pred pred)
+  {
+    size_t size = db_.size();
+    size_t partitions = (std::min)(partitions_, size);
+    if (partitions < 2 || size < minParallelSize_)
     {
-      if (callObj(item.second))
-        newKeys.push_back(item.first);
+      Keys keys;
+      for (auto& item : db_)
+      {
+        if (pred(item.second))
+          keys.push_back(item.first);
+      }
+      return keys;
     }
-    keys_ = newKeys;
-    return *this;
+    DbCore<P>& db = db_;
+    auto scanRange = [&db, size, partitions](size_t part, Pred pred) {
+      Keys keys;
+      size_t first = size * part / partitions;
+      size_t count = size * (part + 1) / partitions - first;
+      auto iter = db.nth(first);
+      for (; count > 0; --count, ++iter)
+      {
+        if (pred(iter->second))
+          keys.push_back(iter->first);
+      }
+      return keys;
+    };
+    Utilities::ThreadPool& pool = Utilities::ThreadPool::shared();
+    Utilities::ThreadPool::Group group = pool.newGroup();
+    std::vector<std::future<Keys>> results;
+    for (size_t part = 1; part < partitions; ++part)
+      results.push_back(pool.submit([=]() { return scanRange(part, pred); }, group));
+    Keys keys = scanRange(0, pred);
+    for (auto& result : results)
+      pool.wait(result, group);
+    for (auto& result : results)
+    {
+      Keys partKeys = result.get();
+      keys.insert(keys.end(), partKeys.begin(), partKeys.end());
+    }
+    return keys;
   }
   /*----< form union of keys with q.keys() >-------------------------*/
 
+  /*
+  *  - keys in q, but not here, are appended in q's order
+  */
   template<typename P>
   Query<P>& Query<P>::query_or(Query<P>& q)
   {
-    Keys keys = q.keys();
-    for (auto key : keys)
+    Keys& keys = this->keys();
+    std::unordered_set<Key> found(keys.begin(), keys.end());
+    for (auto& key : q.keys())
+    {
+      if (found.insert(key).second)
+        keys.push_back(key);
+    }
+    return *this;
+  }
+  /*----< form intersection of keys with q.keys() >------------------*/
+
+  template<typename P>
+  Query<P>& Query<P>::query_and(Query<P>& q)
+  {
+    std::unordered_set<Key> other(q.keys().begin(), q.keys().end());
+    Keys newKeys;
+    for (auto& key : keys())
+    {
+      if (other.erase(key) > 0)
+        newKeys.push_back(key);
+    }
+    result(newKeys);
+    return *this;
+  }
+  /*----< remove keys found in q.keys() >----------------------------*/
+
+  template<typename P>
+  Query<P>& Query<P>::query_not(Query<P>& q)
+  {
+    std::unordered_set<Key> other(q.keys().begin(), q.keys().end());
+    Keys newKeys;
+    for (auto& key : keys())
     {
-      Keys::iterator start = keys_.begin();
-      Keys::iterator end = keys_.end();
-      if(std::find(start, end, key) == end)
-        keys_.push_back(key);
+      if (other.count(key) == 0)
+        newKeys.push_back(key);
     }
+    result(newKeys);
     return *this;
   }
   /*----< displays query results >-----------------------------------*/
   /*
   *  - displays an element for each key in query keys
+  *  - keys no longer in the db are skipped
   */
   template<typename P>
   void Query<P>::show(std::ostream& out)
   {
     showHeader(showKey, out);
-    for (auto key : keys_)
+    for (auto& key : keys())
     {
-      DbElement<P> temp = db_[key];
-      showRecord<P>(key, temp, out);
+      typename DbCore<P>::iterator iter = db_.find(key);
+      if (iter != db_.end())
+        showRecord<P>(key, iter->second, out);
     }
   }
 }
\ No newline at end of file
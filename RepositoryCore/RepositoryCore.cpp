@@ -21,11 +21,21 @@
 *
 * Build Process:
 * ---------------
-* - Required files: RepositoryCore.h,RepositoryCore.cpp,CheckIn.h,CheckOut.h,Browse.h
+* - Required files: RepositoryCore.h,RepositoryCore.cpp,CheckIn.h,CheckOut.h,Browse.h,
+*                   Logger.h,Logger.cpp
 * - Compiler command: devenv Project2.sln /rebuild debug
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.3 : 17th October 2026
+*  - test stub seeds the demo records itself
+*  - test stub fetches the second page of browse results after the first
+*  ver 2.2 : 17th October 2026
+*  - test stub restarts the repository, which replays its check-ins from db.wal
+*  ver 2.1 : 17th October 2026
+*  - test stub shows one page of browse results and metadata
+*  - test stub checks in two files at once while browsing
+*  - test stub shows request diagnostics through the Diagnostics logger
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th March 2018
@@ -34,6 +44,7 @@
 
 #include "../DbCore/DbCore.h"
 #include "RepositoryCore.h"
+#include <thread>
 
 #ifdef REPOSITORYCORE_TEST
 
@@ -42,8 +53,43 @@ using namespace Repository;
 
 //----< test stub>---------------------------
 int main() {
-	RepositoryCore<PayLoad> repoObj;
-	repoObj.browseAFile("DbCore.h.1");
+	Diagnostics::attach(&std::cout);
+	Diagnostics::level(Logger::debug);
+	Diagnostics::start();
+	{
+		RepositoryCore<PayLoad> repoObj;
+		repoObj.seedDemo();
+		std::vector<std::string> page = repoObj.browseAFile("DbCore.h.1", "", 5);
+		for (auto line : page)
+			std::cout << "\n  " << line;
+		if (page.size() > 1 && page[page.size() - 2] == "next page after") {
+			for (auto line : repoObj.browseAFile("DbCore.h.1", page.back(), 5))
+				std::cout << "\n  " << line;
+		}
+		for (auto line : repoObj.getMetaData("DbCore.h.1"))
+			std::cout << "\n  " << line;
+		std::vector<std::thread> checkIns;
+		for (auto file : { "Comm.h", "Comm.cpp" }) {
+			checkIns.push_back(std::thread([&repoObj, file]() {
+				DbElement<PayLoad> elem;
+				elem.name("naga");
+				elem.descrip("checked in while browsing");
+				elem.payLoad().value() = "codeRepository\\remoteRepositoryFiles";
+				repoObj.checkIn(file, elem);
+			}));
+		}
+		repoObj.browseAFile("RepositoryCore.h.1");
+		for (auto& checkIn : checkIns)
+			checkIn.join();
+		for (auto line : repoObj.getMetaData("Comm.cpp.1"))
+			std::cout << "\n  " << line;
+		repoObj.traceRepo();  // below Diagnostics level, so never formatted
+	}
+	RepositoryCore<PayLoad> restarted;  // loads db.snap, then replays db.wal
+	for (auto line : restarted.getMetaData("Comm.cpp.1"))
+		std::cout << "\n  " << line;
+	Diagnostics::stop();
+	std::cout << "\n";
 	return 0;
 }
 
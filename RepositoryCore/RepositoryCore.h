@@ -18,14 +18,72 @@
 	3. DisplayRepo -- to display content a repo
 	4. DisplayAFile -- to display content of file in repo
 	5. BrowseAFile -- browse repository the contents of a file
+*	The repository is a VersionedDb, so it is safe to call from many threads.
+*	Browse, check-out, and metadata requests read the latest committed
+*	snapshot and never wait for check-ins.  Check-ins lock only the file
+*	being checked in, so check-ins of different files run in parallel.
+*	Each check-in appends the records and version numbers it changed to
+*	the write-ahead log, db.wal, and returns once they are on disk, so a
+*	check-in costs the size of its change.  Concurrent check-ins share
+*	one flush.  Once the log holds CheckpointBatches check-ins or
+*	CheckpointBytes bytes, a binary snapshot, db.snap, is saved
+*	asynchronously on the shared ThreadPool, and log entries that
+*	snapshot holds are dropped, so saving db.snap is spread over many
+*	check-ins.  A check-in is appended to the log while its file is
+*	still locked, so check-ins of one file are logged in commit order.
+*	When constructed, the repository loads db.snap, or db.xml, and starts
+*	empty if there is neither, then replays db.wal over it.  The demo
+*	records are added only by seedDemo, which the server calls when run
+*	with /demo.  They are logged like a check-in, so they are kept.  db.snap is
+*	moved to db.snap.mapped and memory-mapped, so startup reads only its
+*	index, and each record is decoded the first time it is used.  saveXML
+*	exports the repository to db.xml.
+*	The repository leaves DbCore's secondary indexes off, since building
+*	them would decode every record at startup.  Browse matches on the
+*	description, which no index covers, so it scans in key order and
+*	stops once its page is full.
+*	Requests write nothing to std::cout.  Their progress goes to the
+*	Diagnostics logger, at debug level, and traceRepo sends the whole
+*	repository at trace level, only when Diagnostics is started.
 *
 * Build Process:
 * ---------------
-* - Required files: RepositoryCore.h,RepositoryCore.cpp,CheckIn.h,CheckOut.h,Browse.h
+* - Required files: RepositoryCore.h,RepositoryCore.cpp,CheckIn.h,CheckOut.h,Browse.h,ThreadPool.h,VersionedDb.h,
+*                   WriteAheadLog.h,BinaryCodec.h,MappedSnapshot.h,Logger.h,Logger.cpp
 * - Compiler command: devenv Project2.sln /rebuild debug
 *
 *  Maintenance History:
 *  --------------------
+*  ver 2.7 : 17th October 2026
+*  - browseAFile pages after a key instead of at an offset
+*  - demo records are added by seedDemo, not by the constructor
+*  - db.snap is saved when the log passes a size or check-in count,
+*    not after every check-in
+*  - check-ins are appended to the log before their file is unlocked
+*  - a check-in copies only its file's and children's version numbers
+*  ver 2.6 : 17th October 2026
+*  - db.xml is streamed from the repository, not built as a string
+*  ver 2.5 : 17th October 2026
+*  - db.xml is streamed into the repository, not read into a string
+*  ver 2.4 : 17th October 2026
+*  - db.snap is loaded lazily from a memory-mapped db.snap.mapped
+*  ver 2.3 : 17th October 2026
+*  - snapshots are saved to db.snap in Persist's binary format, db.xml
+*    is only written by saveXML and read if there is no db.snap
+*  - saveXMLAsync renamed saveSnapshotAsync
+*  ver 2.2 : 17th October 2026
+*  - check-ins are logged to db.wal and replayed over db.xml on startup
+*  - db.xml is written to db.xml.tmp, then moved into place
+*  - versions are merged before a check-in commits, while its file is locked
+*  ver 2.1 : 17th October 2026
+*  - browseAFile passes offset and limit through to Browse
+*  - request messages go to the Diagnostics logger instead of std::cout,
+*    added traceRepo
+*  - browse and metadata served from the live repository, demo records
+*    are added once when constructed instead of on every request
+*  - db.xml saved asynchronously after check-in from a snapshot
+*  - repository held in a VersionedDb: readers use snapshots, check-ins
+*    lock only their file, and version numbers are guarded by their own lock
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4th March 2018
@@ -34,7 +92,10 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include "../DbCore/DbCore.h"
+#include "../DbCore/VersionedDb.h"
+#include "../DbCore/WriteAheadLog.h"
 #include "../PayLoad/PayLoad.h"
 #include "../DbCore/Definitions.h"
 #include "../CheckIn/CheckIn.h"
@@ -42,6 +103,13 @@
 #include "../Browse/Browse.h"
 #include "../Version/Version.h"
 #include "../Persist/Persist.h"
+#include "../Persist/MappedSnapshot.h"
+#include "../Utilities/ThreadPool/ThreadPool.h"
+#include "../CppCommWithFileXfer/Logger/Logger.h"
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
 
 using namespace NoSqlDb;
 
@@ -52,22 +120,57 @@ namespace Repository {
 	public:
 		//RepositoryCore(DbCore<T> & db):repo_(db) {}
 		using VersionInfo = std::unordered_map<Key, size_t>;
+		using Snapshot = typename VersionedDb<T>::Snapshot;
+		static const size_t CheckpointBatches = 1000;
+		static const size_t CheckpointBytes = 4 * 1024 * 1024;
 		RepositoryCore();
+		~RepositoryCore();
+		RepositoryCore(const RepositoryCore&) = delete;
+		RepositoryCore& operator=(const RepositoryCore&) = delete;
 		static void identify(std::ostream& out = std::cout);
 		bool checkIn(Key key_, DbElement<T> elem_);
 		std::vector<std::string> checkOut(const Key& key_,std::string dest);
 		void displayRepo();
+		void traceRepo();
 		void displayAFile(const Key& key_);
-		std::vector<std::string> browseAFile(const Key& key_);
-		void createDb(NoSqlDb::DbCore<NoSqlDb::PayLoad> & tempRepo_);
+		std::vector<std::string> browseAFile(const Key& key_, const Key& after = "", size_t limit = Cursor<T>::noLimit);
+		bool seedDemo();
 		std::vector<std::string> getMetaData(const Key& key_);
 		void saveXML();
+		void saveSnapshotAsync();
+		void flush();
+		Snapshot snapshot();
 	private:
-		DbCore<T> repo_;
+		static void createDb(NoSqlDb::DbCore<NoSqlDb::PayLoad> & tempRepo_);
+		static bool readSnapshot(DbCore<T>& db);
+		static void restoreSnapshot();
+		static bool writeSnapshot(DbCore<T>& db);
+		static bool readXML(DbCore<T>& db);
+		static bool writeXML(DbCore<T>& db);
+		void saveProc();
+		void checkpointIfDue();
+		WriteAheadLog::Ticket commit(typename VersionedDb<T>::Transaction& trans, const std::string& batch);
+		void saveSnapshot(Snapshot snap, WriteAheadLog::Ticket upTo);
+		VersionInfo versions();
+		VersionInfo versions(const Key& key, const Children& children);
+		void mergeVersions(const VersionInfo& versions, std::string& batch);
+		std::string versionBatch();
+		WriteAheadLog wal_;
+		VersionedDb<T> repo_;
 		CheckIn<T> checkIn_;
 		Browse<T> browse;
 		CheckOut<T>  checkOut_;
 		VersionInfo versionInfo_;
+		std::mutex versionMtx_;
+		std::mutex saveMtx_;
+		Snapshot pendingSave_;
+		WriteAheadLog::Ticket pendingTicket_ = 0;
+		bool saving_ = false;
+		std::future<void> saveDone_;
+		std::mutex writeMtx_;
+		WriteAheadLog::Ticket savedTicket_ = 0;
+		std::mutex commitMtx_;
+		std::atomic<size_t> unsaved_{ 0 };
 	};
 	//----< helper function to identiry files>---------------------------
 	template<typename T>
@@ -79,53 +182,332 @@ namespace Repository {
 	//----< helper function to checkin files>---------------------------
 	template<typename T>
 	bool RepositoryCore<T>::checkIn(Key key_, DbElement<T> elem_) {
-		std::cout << "\nDemonstrating requirement #2: Repository server providing checkin functionality";
-		return checkIn_.checkInAFile(key_,elem_,repo_, versionInfo_);
+		LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement #2: Repository server providing checkin functionality");
+		typename VersionedDb<T>::Transaction trans = repo_.begin(Keys{ key_ });
+		VersionInfo versionInfo = versions(key_, elem_.children());
+		bool checkedIn = checkIn_.checkInAFile(key_, elem_, trans.db(), versionInfo);
+		std::string batch;
+		WriteAheadLog::logChanges(batch, trans.db());
+		mergeVersions(versionInfo, batch);
+		wal_.sync(commit(trans, batch));
+		checkpointIfDue();
+		return checkedIn;
+	}
+	//----< helper function to log a transaction's batch and commit it>---------------------------
+	/*
+	*  - the batch is appended while the transaction still holds its key
+	*    locks, so changes to a key reach the log in commit order
+	*  - commitMtx_ keeps saveSnapshotAsync from taking a ticket for a
+	*    batch whose changes are not yet in the snapshot it saves
+	*  - returns the batch's ticket, sync it once the locks are released
+	*/
+	template<typename T>
+	WriteAheadLog::Ticket RepositoryCore<T>::commit(typename VersionedDb<T>::Transaction& trans, const std::string& batch) {
+		std::lock_guard<std::mutex> lock(commitMtx_);
+		WriteAheadLog::Ticket ticket = wal_.append(batch);
+		trans.commit();
+		return ticket;
+	}
+	//----< helper function to copy version numbers>---------------------------
+	template<typename T>
+	typename RepositoryCore<T>::VersionInfo RepositoryCore<T>::versions() {
+		std::lock_guard<std::mutex> lock(versionMtx_);
+		return versionInfo_;
+	}
+	//----< helper function to copy the version numbers a check-in reads>---------------------------
+	/*
+	*  - copies only key's and its children's entries, so a check-in costs
+	*    the number of its children, not of files in the repository
+	*  - keys are reduced to file names the way Version looks them up
+	*/
+	template<typename T>
+	typename RepositoryCore<T>::VersionInfo RepositoryCore<T>::versions(const Key& key, const Children& children) {
+		Keys files{ key };
+		files.insert(files.end(), children.begin(), children.end());
+		Version ver;
+		VersionInfo versionInfo;
+		std::lock_guard<std::mutex> lock(versionMtx_);
+		for (auto file : files) {
+			size_t version = ver.getVersionInfo(file, versionInfo_);
+			if (version > 0)
+				versionInfo[file] = version;
+		}
+		return versionInfo;
+	}
+	//----< helper function to keep the newest of each version number>---------------------------
+	/*
+	*  - check-ins of different files run at once, each on its own copy
+	*  - adds an entry to batch for each version number raised
+	*/
+	template<typename T>
+	void RepositoryCore<T>::mergeVersions(const VersionInfo& versionInfo, std::string& batch) {
+		std::lock_guard<std::mutex> lock(versionMtx_);
+		for (auto& item : versionInfo) {
+			typename VersionInfo::iterator iter = versionInfo_.find(item.first);
+			if (iter == versionInfo_.end())
+				versionInfo_.insert(item);
+			else if (iter->second < item.second)
+				iter->second = item.second;
+			else
+				continue;
+			WriteAheadLog::logVersion(batch, item.first, item.second);
+		}
+	}
+	//----< helper function to log every version number>---------------------------
+	/*
+	*  - snapshots don't hold version numbers, so checkpoints keep them in db.wal
+	*/
+	template<typename T>
+	std::string RepositoryCore<T>::versionBatch() {
+		std::string batch;
+		for (auto& item : versions())
+			WriteAheadLog::logVersion(batch, item.first, item.second);
+		return batch;
 	}
 	//----< helper function to check out files>---------------------------
 	template<typename T>
 	std::vector<std::string> RepositoryCore<T>::checkOut(const Key& key_, std::string dest) {
-		std::cout << "\nDemonstrating requirement #2: Repository server providing checkout functionality";
-		return checkOut_.checkOutFile(key_, dest,repo_);
+		LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement #2: Repository server providing checkout functionality");
+		Snapshot snap = repo_.read();
+		return checkOut_.checkOutFile(key_, dest, *snap);
 	} 
 	//----< helper function to display repo>---------------------------
 	template<typename T>
 	void RepositoryCore<T>::displayRepo() {
-		showDb(repo_);
+		showDb(*repo_.read());
+	}
+	//----< helper function to send repo to Diagnostics>---------------------------
+	/*
+	*  - formats nothing unless Diagnostics logs at trace level
+	*/
+	template<typename T>
+	void RepositoryCore<T>::traceRepo() {
+		if (!Diagnostics::enabled(Logger::trace))
+			return;
+		std::ostringstream out;
+		showDb(*repo_.read(), out);
+		Diagnostics::write(Logger::trace, out.str());
 	}
 	//----< helper function to save repo as XML>---------------------------
 	template<typename T>
 	void RepositoryCore<T>::saveXML() {
-		std::cout << "\nDemonstrating: Saving to XML";
-		Persist<PayLoad> persist(repo_);
-		Xml xml = persist.toXml();
+		LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating: Saving to XML");
+		flush();
+		writeXML(*repo_.read());
+	}
+	//----< helper function to load db from the last snapshot saved, if there is one>---------------------------
+	/*
+	*  - db.snap is moved to db.snap.mapped, which stays mapped while the repository
+	*    runs, so new snapshots can still be saved to db.snap
+	*  - snapshots saved before records had checksums are read in full
+	*/
+	template<typename T>
+	bool RepositoryCore<T>::readSnapshot(DbCore<T>& db) {
+		restoreSnapshot();
+		if (std::ifstream("db.snap").good()) {
+			std::remove("db.snap.mapped");
+			if (std::rename("db.snap", "db.snap.mapped") != 0)
+				throw std::exception("can't move db.snap to db.snap.mapped");
+		}
+		std::shared_ptr<MappedSnapshot<PayLoad>> pSnap = MappedSnapshot<PayLoad>::open("db.snap.mapped");
+		if (pSnap) {
+			db.clear();
+			pSnap->load(db);
+			return true;
+		}
+		std::ifstream myfile("db.snap.mapped", std::ios::binary);
+		if (!myfile.good())
+			return false;
+		Persist<PayLoad> persist(db);
+		return persist.fromBinary(myfile, rebuild);
+	}
+	//----< helper function to finish or discard a save of db.snap that was interrupted>---------------------------
+	/*
+	*  - db.snap is moved aside while the repository runs, so a db.snap.tmp without
+	*    db.snap may be partly written, and is kept only if its index is intact
+	*/
+	template<typename T>
+	void RepositoryCore<T>::restoreSnapshot() {
+		if (!std::ifstream("db.snap.tmp").good())
+			return;
+		bool complete = false;
+		if (!std::ifstream("db.snap").good()) {
+			try {
+				complete = MappedSnapshot<PayLoad>::open("db.snap.tmp") != nullptr;
+			}
+			catch (std::exception&) {}
+		}
+		if (complete)
+			std::rename("db.snap.tmp", "db.snap");
+		else
+			std::remove("db.snap.tmp");
+	}
+	//----< helper function to write db as binary snapshot to db.snap>---------------------------
+	/*
+	*  - a crash while writing leaves the previous db.snap in place
+	*/
+	template<typename T>
+	bool RepositoryCore<T>::writeSnapshot(DbCore<T>& db) {
+		Persist<PayLoad> persist(db);
+		ofstream myfile("db.snap.tmp", std::ios::binary);
+		persist.toBinary(myfile);
+		myfile.close();
+		if (myfile.fail())
+			return false;
+		try {
+			WriteAheadLog::replaceFile("db.snap.tmp", "db.snap");
+		}
+		catch (std::exception& ex) {
+			LOG_WRITE(Diagnostics, Logger::error, "\n  can't save db.snap: ", ex.what());
+			return false;
+		}
+		return true;
+	}
+	//----< helper function to load db from db.xml, if there is one>---------------------------
+	template<typename T>
+	bool RepositoryCore<T>::readXML(DbCore<T>& db) {
+		WriteAheadLog::restoreFile("db.xml.tmp", "db.xml");
+		std::ifstream myfile("db.xml");
+		if (!myfile.good())
+			return false;
+		Persist<PayLoad> persist(db);
+		return persist.fromXml(myfile, rebuild);
+	}
+	//----< helper function to write db as XML to db.xml>---------------------------
+	/*
+	*  - a crash while writing leaves the previous db.xml in place
+	*/
+	template<typename T>
+	bool RepositoryCore<T>::writeXML(DbCore<T>& db) {
+		Persist<PayLoad> persist(db);
 		ofstream myfile;
-		myfile.open("db.xml");
-		myfile << xml;
+		myfile.open("db.xml.tmp");
+		persist.toXml(myfile);
 		myfile.close();
+		if (myfile.fail())
+			return false;
+		try {
+			WriteAheadLog::replaceFile("db.xml.tmp", "db.xml");
+		}
+		catch (std::exception& ex) {
+			LOG_WRITE(Diagnostics, Logger::error, "\n  can't save db.xml: ", ex.what());
+			return false;
+		}
+		return true;
+	}
+	//----< helper function to save snapshot and drop the log entries it holds>---------------------------
+	/*
+	*  - snap holds every change logged up to upTo
+	*  - a snapshot older than the one last saved is not written
+	*/
+	template<typename T>
+	void RepositoryCore<T>::saveSnapshot(Snapshot snap, WriteAheadLog::Ticket upTo) {
+		std::lock_guard<std::mutex> lock(writeMtx_);
+		if (upTo < savedTicket_ || !writeSnapshot(*snap))
+			return;
+		savedTicket_ = upTo;
+		wal_.checkpoint(upTo, versionBatch());
+	}
+	//----< helper function to return latest committed version of repo>---------------------------
+	/*
+	*  - snapshot is shared with other readers, so callers must not modify it
+	*/
+	template<typename T>
+	typename RepositoryCore<T>::Snapshot RepositoryCore<T>::snapshot() {
+		return repo_.read();
+	}
+	//----< helper function to save repo snapshot on a pool thread>---------------------------
+	/*
+	*  - if a save is already running it writes this snapshot when done,
+	*    so bursts of check-ins write db.snap once or twice, not once each
+	*/
+	template<typename T>
+	void RepositoryCore<T>::saveSnapshotAsync() {
+		WriteAheadLog::Ticket upTo;
+		Snapshot snap;
+		{
+			std::lock_guard<std::mutex> lock(commitMtx_);
+			upTo = wal_.end();
+			snap = snapshot();
+		}
+		std::lock_guard<std::mutex> lock(saveMtx_);
+		pendingSave_ = snap;
+		pendingTicket_ = upTo;
+		if (saving_)
+			return;
+		saving_ = true;
+		saveDone_ = Utilities::ThreadPool::shared().submit([this]() { saveProc(); });
+	}
+	//----< helper function to save a snapshot once the log is long enough>---------------------------
+	/*
+	*  - a check-in costs O(repository) only once every CheckpointBatches
+	*    check-ins or CheckpointBytes of log, not every time
+	*  - while a save runs, the log stays long, so it isn't started again
+	*/
+	template<typename T>
+	void RepositoryCore<T>::checkpointIfDue() {
+		if (++unsaved_ < CheckpointBatches && wal_.size() < CheckpointBytes)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(saveMtx_);
+			if (saving_)
+				return;
+		}
+		unsaved_ = 0;
+		saveSnapshotAsync();
+	}
+	//----< helper function to write pending snapshots until none are left>---------------------------
+	template<typename T>
+	void RepositoryCore<T>::saveProc() {
+		while (true) {
+			Snapshot snap;
+			WriteAheadLog::Ticket upTo;
+			{
+				std::lock_guard<std::mutex> lock(saveMtx_);
+				if (!pendingSave_) {
+					saving_ = false;
+					return;
+				}
+				snap.swap(pendingSave_);
+				upTo = pendingTicket_;
+			}
+			saveSnapshot(snap, upTo);
+		}
+	}
+	//----< helper function to wait for asynchronous saves to finish>---------------------------
+	template<typename T>
+	void RepositoryCore<T>::flush() {
+		std::future<void> saveDone;
+		{
+			std::lock_guard<std::mutex> lock(saveMtx_);
+			saveDone = std::move(saveDone_);
+		}
+		if (saveDone.valid())
+			saveDone.get();
 	}
 	//----< helper function to display a file>---------------------------
 	template<typename T>
 	void RepositoryCore<T>::displayAFile(const Key& key_) {
-		browse.displayFile(key_,repo_);
+		Snapshot snap = repo_.read();
+		browse.displayFile(key_, *snap);
 	}
 	//----< helper function to browse a file>---------------------------
 	template<typename T>
-	std::vector<std::string> RepositoryCore<T>::browseAFile(const Key& key_) {
-		saveXML();
-		DbCore<T> tempRepo_;
-		createDb(tempRepo_);
-		std::cout << "\nDemonstrating requirement #2: Repository server providing browse functionality";
-		return browse.browseFile(key_, tempRepo_);
+	std::vector<std::string> RepositoryCore<T>::browseAFile(const Key& key_, const Key& after, size_t limit) {
+		LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement #2: Repository server providing browse functionality");
+		Snapshot snap = repo_.read();
+		return browse.browseFile(key_, *snap, after, limit);
 	}
 
 	//----< helper function to browse a file>---------------------------
 	template<typename T>
 	std::vector<std::string> RepositoryCore<T>::getMetaData(const Key& key_) {
-		std::cout << "\nDemonstrating requirement of viewing metadata of a file. In GUI it can be seen in View MetaData";
-		DbCore<T> tempRepo_;
-		createDb(tempRepo_);
-		DbElement<T> elem_ = tempRepo_[key_];
+		LOG_WRITE(Diagnostics, Logger::debug, "\nDemonstrating requirement of viewing metadata of a file. In GUI it can be seen in View MetaData");
+		DbElement<T> elem_;
+		Snapshot snap = repo_.read();
+		typename DbCore<T>::iterator iter = snap->find(key_);
+		if (iter != snap->end())
+			elem_ = iter->second;
 		std::vector<std::string> metaData;
 		std::string temp;
 		metaData.push_back(temp.append("Name: ").append(elem_.name()));
@@ -160,9 +542,36 @@ namespace Repository {
 		metaData.push_back(temp.append("Path: ").append(pl.value()));
 		return metaData;
 	}
+	//----< helper function to load last snapshot and replay the log over it>---------------------------
+	template<typename T>
+	RepositoryCore<T>::RepositoryCore() : wal_("db.wal") {
+		typename VersionedDb<T>::Transaction trans = repo_.begin(Keys());
+		if (!readSnapshot(trans.db()))
+			readXML(trans.db());
+		size_t replayed = wal_.replay(trans.db(), versionInfo_);
+		trans.commit();
+		LOG_WRITE(Diagnostics, Logger::debug, "\n  replayed ", replayed, " entries from db.wal");
+	}
+	//----< helper function to add the demo records to an empty repository>---------------------------
+	/*
+	*  - for demonstrations and tests only, call before serving requests
+	*  - returns false, adding nothing, if the repository holds any record
+	*/
+	template<typename T>
+	bool RepositoryCore<T>::seedDemo() {
+		typename VersionedDb<T>::Transaction trans = repo_.begin(Keys());
+		if (trans.db().size() > 0)
+			return false;
+		createDb(trans.db());
+		std::string batch;
+		WriteAheadLog::logChanges(batch, trans.db());
+		wal_.sync(commit(trans, batch));
+		return true;
+	}
+	//----< helper function to finish pending saves before destruction>---------------------------
 	template<typename T>
-	RepositoryCore<T>::RepositoryCore() {
-		
+	RepositoryCore<T>::~RepositoryCore() {
+		flush();
 	}
 
 	//----< make Repository Test database >-----------------------------------
@@ -203,7 +612,7 @@ namespace Repository {
 	template<typename T>
 	void RepositoryCore<T>::createDb(NoSqlDb::DbCore<NoSqlDb::PayLoad> & tempRepo_)
 	{
-		std::cout << "\nCreating database to demonstrate browse";
+		LOG_WRITE(Diagnostics, Logger::debug, "\nCreating database to demonstrate browse");
 		PayLoad pl;
 		pl.value() = "codeRepository\\remoteRepositoryFiles";
 		pl.categories().push_back("repositoryCore");
@@ -19,16 +19,52 @@
 *  Message handling runs on a child thread, so the Server main thread is free to do
 *  any necessary background processing (none, so far).
 *
+*  The message handling thread only receives and classifies messages.  Each request
+*  is processed on the server's ThreadPool:
+*  - read requests run in parallel with each other and with writes, reading the
+*    repository's latest committed snapshot
+*  - write requests, like checkInFiles, are queued per written key, so writes to the
+*    same key run one at a time in arrival order, while writes to different keys
+*    run in parallel
+*  - a reply carries the request's "requestId" attribute, if it had one, so clients
+*    can match replies that arrive out of order
+*
+*  Each request is moved, never copied, from Comm's receive queue to the ServerProc
+*  that handles it, and each reply is moved back into Comm's send queue.
+*
+*  At most limits() highWater requests are in progress at once.  Beyond that the
+*  message handling thread stops taking requests until lowWater are left, Comm's
+*  receive queue fills, and requests arriving at a full queue are answered with
+*  "server busy" replies, carrying retryAfter, so clients back off and repost.
+*
+*  Requests and replies are not written to std::cout.  They, and the requirement
+*  demonstrations, go to the Diagnostics logger, which is off unless the server is
+*  started with /d, so a production server does no console I/O per request.
+*
 *  Required Files:
 * -----------------
 *  ServerPrototype.h, ServerPrototype.cpp
-*  Comm.h, Comm.cpp, IComm.h
+*  Comm.h, Comm.cpp, IComm.h, Watermarks.h
+*  Logger.h, Logger.cpp
 *  Message.h, Message.cpp
 *  FileSystem.h, FileSystem.cpp
-*  Utilities.h
+*  Utilities.h, ThreadPool.h
 *
 *  Maintenance History:
 * ----------------------
+*  ver 2.2 : 17th October 2026
+*  - added seedDemo, repository demo records are added only when asked for
+*  - serverQuit leaves the in-progress count it entered
+*  - serve leaves the in-progress count even if processing throws, and invoke
+*    replies with an error for exceptions not derived from std::exception
+*  ver 2.1 : 17th October 2026
+*  - requests dispatched to a thread pool, writes serialized per key
+*  - repository-wide lock removed, RepositoryCore now synchronizes its readers
+*    and writers
+*  - Comm started in polled mode, so idle clients don't each hold a thread
+*  - requests and replies are moved through the server, ServerProcs take Msg&&
+*  - requests in progress are limited, and a busy server replies "server busy"
+*  - per request output goes to the Diagnostics logger, off by default
 *  ver 2.0 : 27th April 2018
 *  - second release
 *  ver 1.0 : 4/6/2018
@@ -39,12 +75,19 @@
 #include <unordered_map>
 #include <functional>
 #include <thread>
+#include <mutex>
+#include <deque>
+#include <unordered_set>
+#include <memory>
+#include <sstream>
 #include "../CppCommWithFileXfer/Message/Message.h"
 #include "../CppCommWithFileXfer/MsgPassingComm/Comm.h"
+#include "../CppCommWithFileXfer/Logger/Logger.h"
 #include <windows.h>
 #include <tchar.h>
 #include "../RepositoryCore/RepositoryCore.h"
 #include "../PayLoad/PayLoad.h"
+#include "../Utilities/ThreadPool/ThreadPool.h"
 
 
 
@@ -57,61 +100,111 @@ namespace NoSqlDb
   using SearchPath = std::string;
   using Key = std::string;
   using Msg = MsgPassingCommunication::Message;
-  using ServerProc = std::function<Msg(Msg)>;
+  using ServerProc = std::function<Msg(Msg&&)>;
   using MsgDispatcher = std::unordered_map<Key,ServerProc>;
   
   const SearchPath storageRoot = "../Storage";  // root for all server file storage
   const MsgPassingCommunication::EndPoint serverEndPoint("localhost", 8080);  // listening endpoint
+  const size_t DefaultHighWater = 1024;  // requests in progress before server is busy
+  const size_t DefaultLowWater = 768;    // requests in progress when server takes more
 
   class Server
   {
   public:
-    Server(MsgPassingCommunication::EndPoint ep, const std::string& name);
+    Server(MsgPassingCommunication::EndPoint ep, const std::string& name,
+      size_t numWorkers = Utilities::ThreadPool::defaultThreads());
 	void start();
     void stop();
     void addMsgProc(Key key, ServerProc proc);
+    void addWriteCommand(Key command) { writeCommands_.insert(command); }
+    void limits(size_t highWater, size_t lowWater);
+    bool seedDemo() { return repo_.seedDemo(); }
     void processMessages();
-    void postMessage(MsgPassingCommunication::Message msg);
+    void postMessage(const MsgPassingCommunication::Message& msg);
+    void postMessage(MsgPassingCommunication::Message&& msg);
     MsgPassingCommunication::Message getMessage();
     static Dirs getDirs(const SearchPath& path = storageRoot);
     static Files getFiles(const SearchPath& path = storageRoot);
-	Msg browse(Msg msg);
-	Msg checkOut(Msg msg);
-	Msg checkIn(Msg msg);
-	Msg checkInFiles(Msg msg);
-	Msg viewMetadata(Msg msg);
+	Msg browse(Msg&& msg);
+	Msg checkOut(Msg&& msg);
+	Msg checkIn(Msg&& msg);
+	Msg checkInFiles(Msg&& msg);
+	Msg viewMetadata(Msg&& msg);
   private:
+    Msg invoke(Msg&& msg);
+    Msg callProc(Msg&& msg);
+    static Msg errorReply(Msg& msg, const std::string& error);
+    static std::string showMessage(const std::string& title, Msg& msg);
+    void serve(Msg&& msg);
+    void submitRead(Msg&& msg);
+    void submitWrite(Msg&& msg);
+    void drainWrites(const Key& key);
+    static Key writeKey(Msg& msg);
+
     MsgPassingCommunication::Comm comm_;
     MsgDispatcher dispatcher_;
     std::thread msgProcThrd_;
 	Repository::RepositoryCore<PayLoad> repo_;
-	
+    std::unique_ptr<Utilities::ThreadPool> pWorkers_;
+    std::unordered_set<Key> writeCommands_;
+    std::mutex writeMtx_;
+    std::unordered_map<Key, std::deque<Msg>> writeQueues_;
+    MsgPassingCommunication::Watermarks pending_;
   };
   //----< initialize server endpoint and give server a name >----------
 
-  inline Server::Server(MsgPassingCommunication::EndPoint ep, const std::string& name)
-    : comm_(ep, name) {}
+  inline Server::Server(MsgPassingCommunication::EndPoint ep, const std::string& name, size_t numWorkers)
+    : comm_(ep, name), pWorkers_(new Utilities::ThreadPool(numWorkers))
+  {
+    writeCommands_.insert("checkIn");
+    writeCommands_.insert("checkInFiles");
+    limits(DefaultHighWater, DefaultLowWater);
+  }
+  //----< limit requests in progress, and queued in Comm >-------------
+  /*
+  *  - a full receive queue rejects requests with busy replies, a full
+  *    send queue makes workers wait to post their replies
+  */
+  inline void Server::limits(size_t highWater, size_t lowWater)
+  {
+    pending_.limits(highWater, lowWater);
+    comm_.receiveLimits(highWater, lowWater, MsgPassingCommunication::reject);
+    comm_.sendLimits(highWater, lowWater, MsgPassingCommunication::block);
+  }
 
   //----< start server's instance of Comm >----------------------------
-
+  /*
+  *  - client connections are served by Comm's IoLoop threads, not a
+  *    thread per connection
+  */
   inline void Server::start()
   {
-    comm_.start();
+    comm_.startPolled();
   }
   //----< stop Comm instance >-----------------------------------------
 
+  /*
+  *  - requests already received are processed before Comm is stopped
+  */
   inline void Server::stop()
   {
     if(msgProcThrd_.joinable())
       msgProcThrd_.join();
+    pWorkers_.reset();
     comm_.stop();
   }
-  //----< pass message to Comm for sending >---------------------------
+  //----< pass copy of message to Comm for sending >-------------------
 
-  inline void Server::postMessage(MsgPassingCommunication::Message msg)
+  inline void Server::postMessage(const MsgPassingCommunication::Message& msg)
   {
     comm_.postMessage(msg);
   }
+  //----< move message to Comm for sending >---------------------------
+
+  inline void Server::postMessage(MsgPassingCommunication::Message&& msg)
+  {
+    comm_.postMessage(std::move(msg));
+  }
   //----< get message from Comm >--------------------------------------
 
   inline MsgPassingCommunication::Message Server::getMessage()
@@ -123,9 +216,13 @@ namespace NoSqlDb
 
   inline void Server::addMsgProc(Key key, ServerProc proc)
   {
-    dispatcher_[key] = proc;
+    dispatcher_[key] = std::move(proc);
   }
   //----< start processing messages on child thread >------------------
+  /*
+  *  - waits while highWater requests are in progress, so a busy server
+  *    leaves new requests in Comm's receive queue
+  */
 
   inline void Server::processMessages()
   {
@@ -135,39 +232,21 @@ namespace NoSqlDb
         return;
       }
       while (true){
+        pending_.enter(MsgPassingCommunication::block);
         Msg msg = getMessage();
-        std::cout << "\n\n  received message: " << msg.command() << " from " << msg.from().toString();
-        if (msg.containsKey("verbose")){
-			std::cout << "\n";msg.show();
+        LOG_WRITE(Diagnostics, Logger::info, "\n\n  received message: ", msg.command(), " from ", msg.from().toString());
+        if (msg.containsKey("verbose") && Diagnostics::enabled(Logger::debug)){
+			Diagnostics::write(Logger::debug, showMessage("", msg));
         }
         if (msg.command() == "serverQuit")
+        {
+          pending_.leave();  // serverQuit is never submitted, so never leaves
           break;
-		Msg reply;
-		if (msg.command() == "browseDescription") 
-			reply = browse(msg);
-		else if (msg.command() == "metadataContent")
-			reply = viewMetadata(msg);
-		else if (msg.command() == "checkOutFiles")
-			reply = checkOut(msg);
-		else if (msg.command() == "checkIn")
-			reply = checkIn(msg);
-		else if (msg.command() == "checkInFiles")
-			reply = checkInFiles(msg);
-		else {
-			reply = dispatcher_[msg.command()](msg);
-			if (msg.to().port == msg.from().port)  // avoid infinite message loop
-				std::cout << "\n  server attempting to post to self";
-		}
-		std::cout << "\nDemonstrating requirement #4 and #5: "
-			<<"\n\t4. Message passing communication system: The below request message is received, via sockets,"
-			<<"\n\t   from GUI(one process) to access specific functionality of Repository(another process) "
-			<<"\n\t5. Asynchronous communication: The below request and reply messages are communicated in HTTP style."
-			<<"\n\t   Also, the sending process(GUI) sent the messages and is not waiting for reply messages.";
-		std::cout << "\nRequest Message";std::cout << "\n----------------------";
-		msg.show();
-		std::cout << "\nReply Message";std::cout << "\n----------------------";
-		reply.show();
-		postMessage(reply);
+        }
+		if (writeCommands_.count(msg.command()) > 0)
+			submitWrite(std::move(msg));
+		else
+			submitRead(std::move(msg));
       }
       std::cout << "\n  server message processing thread is shutting down";
     };
@@ -175,6 +254,162 @@ namespace NoSqlDb
     std::cout << "\n  starting server thread to process messages";
     msgProcThrd_ = std::move(t);
   }
+  //----< make reply reporting that msg could not be processed >-------
+
+  inline Msg Server::errorReply(Msg& msg, const std::string& error)
+  {
+	Msg reply;
+	reply.to(msg.from());
+	reply.from(msg.to());
+	reply.command(msg.command());
+	reply.attribute("error", error);
+	return reply;
+  }
+  //----< format msg, under title, for Diagnostics >-------------------
+
+  inline std::string Server::showMessage(const std::string& title, Msg& msg)
+  {
+	std::ostringstream out;
+	if (title != "")
+		out << "\n" << title << "\n----------------------";
+	else
+		out << "\n";
+	msg.show(out);
+	return out.str();
+  }
+  //----< process msg, replying with an error if processing throws >---
+  /*
+  *  - the error reply is addressed from a copy of msg's header, since
+  *    the handler may have moved from msg
+  */
+  inline Msg Server::invoke(Msg&& msg)
+  {
+	Msg header(msg.to(), msg.from());
+	header.command(msg.command());
+	try {
+		return callProc(std::move(msg));
+	}
+	catch (std::exception& ex) {
+		LOG_WRITE(Diagnostics, Logger::error, "\n  exception processing ", header.command(), ": ", ex.what());
+		return errorReply(header, ex.what());
+	}
+	catch (...) {
+		LOG_WRITE(Diagnostics, Logger::error, "\n  unknown exception processing ", header.command());
+		return errorReply(header, "unknown exception");
+	}
+  }
+  //----< call the server function or ServerProc for msg's command >---
+
+  inline Msg Server::callProc(Msg&& msg)
+  {
+	std::string command = msg.command();
+	if (command == "browseDescription") 
+		return browse(std::move(msg));
+	else if (command == "metadataContent")
+		return viewMetadata(std::move(msg));
+	else if (command == "checkOutFiles")
+		return checkOut(std::move(msg));
+	else if (command == "checkIn")
+		return checkIn(std::move(msg));
+	else if (command == "checkInFiles")
+		return checkInFiles(std::move(msg));
+	if (msg.to().port == msg.from().port)  // avoid infinite message loop
+		LOG_WRITE(Diagnostics, Logger::warning, "\n  server attempting to post to self");
+	MsgDispatcher::iterator iter = dispatcher_.find(command);
+	if (iter != dispatcher_.end())
+		return iter->second(std::move(msg));
+	LOG_WRITE(Diagnostics, Logger::warning, "\n  no server proc for command ", msg.command());
+	return errorReply(msg, "unknown command");
+  }
+  //----< process msg, tag reply with msg's id and post it >-----------
+  /*
+  *  - leaves the in-progress count on every path, so a throw can't leave
+  *    the server permanently busy
+  */
+  inline void Server::serve(Msg&& msg)
+  {
+	struct Leave {
+		MsgPassingCommunication::Watermarks& pending;
+		~Leave() { pending.leave(); }
+	} leave{ pending_ };
+	if (Diagnostics::enabled(Logger::debug)) {
+		Diagnostics::write(Logger::debug, std::string("\nDemonstrating requirement #4 and #5: ")
+			+ "\n\t4. Message passing communication system: The below request message is received, via sockets,"
+			+ "\n\t   from GUI(one process) to access specific functionality of Repository(another process) "
+			+ "\n\t5. Asynchronous communication: The below request and reply messages are communicated in HTTP style."
+			+ "\n\t   Also, the sending process(GUI) sent the messages and is not waiting for reply messages.");
+		Diagnostics::write(Logger::debug, showMessage("Request Message", msg));
+	}
+	std::string requestId;
+	if (msg.containsKey("requestId"))
+		requestId = msg.value("requestId");
+	Msg reply = invoke(std::move(msg));
+	if (requestId != "")
+		reply.attribute("requestId", requestId);
+	if (Diagnostics::enabled(Logger::debug))
+		Diagnostics::write(Logger::debug, showMessage("Reply Message", reply));
+	postMessage(std::move(reply));
+  }
+  //----< process read request on pool, in parallel with other reads >-
+
+  inline void Server::submitRead(Msg&& msg)
+  {
+	pWorkers_->submit([this, msg = std::move(msg)]() mutable {
+		serve(std::move(msg));
+	});
+  }
+  //----< key whose writes must be serialized >------------------------
+
+  inline Key Server::writeKey(Msg& msg)
+  {
+	if (msg.containsKey("files"))
+		return msg.value("files");
+	if (msg.containsKey("name"))
+		return msg.value("name");
+	return msg.command();
+  }
+  //----< queue write request behind earlier writes to the same key >--
+  /*
+  *  - only the first write for an idle key is submitted to the pool,
+  *    later ones are run by that task, so no pool thread blocks waiting
+  */
+  inline void Server::submitWrite(Msg&& msg)
+  {
+	Key key = writeKey(msg);
+	{
+		std::lock_guard<std::mutex> lock(writeMtx_);
+		std::deque<Msg>& queue = writeQueues_[key];
+		queue.push_back(std::move(msg));
+		if (queue.size() > 1)
+			return;
+	}
+	pWorkers_->submit([this, key]() { drainWrites(key); });
+  }
+  //----< run queued writes for key in arrival order >-----------------
+  /*
+  *  - RepositoryCore locks the records each write touches, this keeps
+  *    a client's writes to one key in the order they were sent
+  *  - the running write is moved out of the queue's front, which stays
+  *    queued until it finishes, so later writes wait behind it
+  */
+  inline void Server::drainWrites(const Key& key)
+  {
+	while (true) {
+		Msg msg;
+		{
+			std::lock_guard<std::mutex> lock(writeMtx_);
+			msg = std::move(writeQueues_[key].front());
+		}
+		serve(std::move(msg));
+		std::lock_guard<std::mutex> lock(writeMtx_);
+		auto iter = writeQueues_.find(key);
+		iter->second.pop_front();
+		if (iter->second.empty()) {
+			writeQueues_.erase(iter);
+			return;
+		}
+	}
+  }
 
   
 }
\ No newline at end of file
@@ -107,7 +107,7 @@ namespace MsgPassingCommunication
   {
     std::cout << "\n  posting message in Translater";
     Message msg = this->fromCsMessage(csMsg);
-    pComm->postMessage(msg);
+    pComm->postMessage(std::move(msg));
   }
   //----< get message from Comm >--------------------------------------
 
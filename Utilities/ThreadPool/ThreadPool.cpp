@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////////////////////////////
+// ThreadPool.cpp - fixed size pool of worker threads                  //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: Remote Code Repository                                 //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPool.h"
+#include "../StringUtilities/StringUtilities.h"
+#include <iostream>
+#include <atomic>
+
+#ifdef TEST_THREADPOOL
+
+using namespace Utilities;
+
+int main()
+{
+  Title("Testing ThreadPool");
+
+  ThreadPool pool(4);
+  std::cout << "\n  pool has " << pool.size() << " threads";
+
+  title("summing 1 to 1000 in ten work items");
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 10; ++i)
+  {
+    results.push_back(pool.submit([i]() {
+      int sum = 0;
+      for (int j = 100 * i + 1; j <= 100 * (i + 1); ++j)
+        sum += j;
+      return sum;
+    }));
+  }
+  int total = 0;
+  for (auto& result : results)
+    total += result.get();
+  std::cout << "\n  sum = " << total;
+
+  title("nested submits wait without deadlock");
+  ThreadPool small(1);
+  std::future<int> outer = small.submit([&small]() {
+    ThreadPool::Group group = small.newGroup();
+    std::future<int> inner = small.submit([]() { return 42; }, group);
+    small.wait(inner, group);
+    return inner.get();
+  });
+  std::cout << "\n  inner result = " << outer.get();
+
+  title("waiting runs only work of its own group");
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<bool> otherRan(false);
+  std::future<bool> waiter = small.submit([&small, &otherRan, released]() {
+    small.submit([&otherRan, released]() { released.wait(); otherRan = true; });
+    ThreadPool::Group group = small.newGroup();
+    std::future<int> mine = small.submit([]() { return 7; }, group);
+    small.wait(mine, group);
+    return !otherRan.load();
+  });
+  bool skipped = waiter.get();
+  release.set_value();
+  std::cout << "\n  ungrouped work left queued while waiting: " << (skipped ? "yes" : "no");
+
+  title("exceptions are returned through futures");
+  std::future<void> failed = pool.submit([]() { throw std::exception("work item failed"); });
+  try
+  {
+    failed.get();
+  }
+  catch (std::exception&)
+  {
+    std::cout << "\n  caught exception thrown by work item";
+  }
+  putline(2);
+  return 0;
+}
+#endif
@@ -0,0 +1,213 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////
+// ThreadPool.h - fixed size pool of worker threads                    //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: Remote Code Repository                                 //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides a single class, ThreadPool, that:
+* - starts a fixed number of worker threads when constructed
+* - runs callable objects submitted with submit(callable), returning a
+*   std::future for the callable's result
+* - tags work with a Group from newGroup(), so a thread waiting on a
+*   future runs only queued work of the same group with runPending(group).
+*   Work submitted from inside a pool thread can't deadlock the pool, and
+*   a waiting thread never picks up unrelated work, e.g., snapshot saves
+* - joins its threads when destroyed, after running all queued work
+* ThreadPool::shared() returns a process-wide pool sized to the machine.
+*
+* Required Files:
+* ---------------
+* ThreadPool.h, ThreadPool.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 17th October 2026
+* - wait and runPending run only work submitted under the awaited group
+* ver 1.1 : 17th October 2026
+* - submit moves its callable object into the task
+* ver 1.0 : 17th October 2026
+* - first release
+*
+* Notes:
+* ------
+* - Designed to provide all functionality in header file.
+* - Implementation file only needed for test and demo.
+*/
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace Utilities
+{
+  class ThreadPool
+  {
+  public:
+    using WorkItem = std::function<void()>;
+    using Group = size_t;
+
+    explicit ThreadPool(size_t numThreads = defaultThreads());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename CallObj>
+    auto submit(CallObj callObj, Group group = 0) -> std::future<decltype(callObj())>;
+    template<typename T>
+    void wait(std::future<T>& result, Group group);
+    bool runPending(Group group);
+    Group newGroup() { return ++lastGroup_; }
+    size_t size() { return threads_.size(); }
+
+    static size_t defaultThreads();
+    static ThreadPool& shared();
+  private:
+    struct Task
+    {
+      Group group;
+      WorkItem item;
+    };
+    void enqueue(Group group, WorkItem item);
+    bool tryDequeue(Group group, WorkItem& item);
+    void threadProc();
+
+    std::vector<std::thread> threads_;
+    std::deque<Task> work_;
+    std::atomic<Group> lastGroup_{ 0 };
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+  };
+  //----< start numThreads workers >-----------------------------------
+
+  inline ThreadPool::ThreadPool(size_t numThreads)
+  {
+    if (numThreads == 0)
+      numThreads = 1;
+    for (size_t i = 0; i < numThreads; ++i)
+      threads_.push_back(std::thread(&ThreadPool::threadProc, this));
+  }
+  //----< run remaining work, then join workers >----------------------
+
+  inline ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thrd : threads_)
+      thrd.join();
+  }
+  //----< number of hardware threads, at least one >-------------------
+
+  inline size_t ThreadPool::defaultThreads()
+  {
+    size_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+  }
+  //----< process-wide pool >------------------------------------------
+
+  inline ThreadPool& ThreadPool::shared()
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+  //----< queue callObj, returning future for its result >-------------
+  /*
+  *  - exceptions thrown by callObj are rethrown by the future's get()
+  *  - callObj is moved into the task, so it may own move-only state
+  *  - group 0 is never run by wait, only by the pool's own threads
+  */
+  template<typename CallObj>
+  auto ThreadPool::submit(CallObj callObj, Group group) -> std::future<decltype(callObj())>
+  {
+    using Result = decltype(callObj());
+    auto pTask = std::make_shared<std::packaged_task<Result()>>(std::move(callObj));
+    std::future<Result> result = pTask->get_future();
+    enqueue(group, [pTask]() { (*pTask)(); });
+    return result;
+  }
+  //----< wait for result, running queued work of group meanwhile >----
+
+  template<typename T>
+  void ThreadPool::wait(std::future<T>& result, Group group)
+  {
+    while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+      if (!runPending(group))
+      {
+        result.wait();
+        return;
+      }
+    }
+  }
+  //----< run one queued work item of group on the calling thread >----
+  /*
+  *  - returns false if there was no queued work in that group
+  */
+  inline bool ThreadPool::runPending(Group group)
+  {
+    WorkItem item;
+    if (group == 0 || !tryDequeue(group, item))
+      return false;
+    item();
+    return true;
+  }
+  //----< add work item to queue >-------------------------------------
+
+  inline void ThreadPool::enqueue(Group group, WorkItem item)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      work_.push_back(Task{ group, std::move(item) });
+    }
+    cv_.notify_one();
+  }
+  //----< remove oldest work item of group, if there is one >----------
+
+  inline bool ThreadPool::tryDequeue(Group group, WorkItem& item)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = std::find_if(work_.begin(), work_.end(),
+      [group](const Task& task) { return task.group == group; });
+    if (iter == work_.end())
+      return false;
+    item = std::move(iter->item);
+    work_.erase(iter);
+    return true;
+  }
+  //----< worker thread processing >-----------------------------------
+
+  inline void ThreadPool::threadProc()
+  {
+    while (true)
+    {
+      WorkItem item;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this]() { return stop_ || !work_.empty(); });
+        if (work_.empty())
+          return;
+        item = std::move(work_.front().item);
+        work_.pop_front();
+      }
+      item();
+    }
+  }
+}
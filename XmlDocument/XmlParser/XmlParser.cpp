@@ -21,6 +21,9 @@
 *
 * XmlParser objects throw if given an invalid path to an XML file.
 *
+* An XmlParser constructed with a std::istream returns parse events,
+* one at a time, from next().  See XmlParser.h.
+*
 * Build Process:
 * ---------------
 * - Required files: XmlParser.h, XmlParser.cpp, XmlElementParts.h, XmlElementParts.cpp,
@@ -30,6 +33,8 @@ XmlElement.cpp,ITokenCollection.h, Tokenizer.h, Tokenizer.cpp
 *
 * Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added streaming mode, with a pull event API
 *  ver 1.0 : 4th Feb 2018
 *  - first release
 */
@@ -45,10 +50,16 @@ XmlElement.cpp,ITokenCollection.h, Tokenizer.h, Tokenizer.cpp
 #include <locale>
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include "../Utilities/Utilities.h"
 
 using namespace XmlProcessing;
 
+namespace
+{
+  const int eof = std::char_traits<char>::eof();
+}
+
 //----< read text file contents into string >--------------------------------
 
 std::string XmlParser::textFileToString(const std::string& fileName)
@@ -339,6 +350,8 @@ void XmlParser::processText(ElemStack& elemStack)
 
 XmlDocument* XmlParser::buildDocument()
 {
+  if (pXmlParts_ == nullptr)
+    throw(std::exception("streaming XmlParser only provides events"));
   XmlDocument* pDoc = new XmlDocument(makeDocElement());
   using sPtr = std::shared_ptr < AbstractXmlElement >;
   sPtr pDocElem = pDoc->docElement();
@@ -365,6 +378,255 @@ XmlDocument* XmlParser::buildDocument()
   if(verbose_) std::cout << "\n";
   return pDoc;
 }
+//----< initialize XmlParser object to read events from stream >-------------
+
+XmlParser::XmlParser(std::istream& in, size_t bufferSize)
+  : pIn_(&in), buffer_(bufferSize > 0 ? bufferSize : 1)
+{
+  good_ = in.good();
+}
+//----< return next character, refilling buffer from stream >----------------
+
+int XmlParser::get()
+{
+  if (bufPos_ == bufEnd_)
+  {
+    if (!pIn_->good())
+      return eof;
+    pIn_->read(&buffer_[0], buffer_.size());
+    bufEnd_ = static_cast<size_t>(pIn_->gcount());
+    bufPos_ = 0;
+    if (bufEnd_ == 0)
+      return eof;
+  }
+  return static_cast<unsigned char>(buffer_[bufPos_++]);
+}
+//----< return next character without consuming it >-------------------------
+
+int XmlParser::peek()
+{
+  int ch = get();
+  if (ch != eof)
+    --bufPos_;
+  return ch;
+}
+//----< append character, throwing if str grows past MaxTextSize >-----------
+
+void XmlParser::append(std::string& str, int ch)
+{
+  if (str.size() >= MaxTextSize)
+    throw(std::exception("XML text too large"));
+  str.push_back(static_cast<char>(ch));
+}
+//----< consume characters up to and including terminator >------------------
+
+void XmlParser::skipPast(const std::string& terminator)
+{
+  std::string window;
+  while (window != terminator)
+  {
+    int ch = get();
+    if (ch == eof)
+      throw(std::exception("ill-formed XML"));
+    window.push_back(static_cast<char>(ch));
+    if (window.size() > terminator.size())
+      window.erase(0, 1);
+  }
+}
+//----< consume whitespace >-------------------------------------------------
+
+void XmlParser::skipSpace()
+{
+  while (peek() != eof && isspace(peek()))
+    get();
+}
+//----< read tag or attribute name >-----------------------------------------
+
+std::string XmlParser::readName()
+{
+  std::string name;
+  while (true)
+  {
+    int ch = peek();
+    if (ch == eof || isspace(ch) || ch == '/' || ch == '>' || ch == '=')
+      return name;
+    append(name, get());
+  }
+}
+//----< return characters up to terminator, consuming terminator >-----------
+
+std::string XmlParser::readUntil(const std::string& terminator)
+{
+  std::string str;
+  while (str.size() < terminator.size() ||
+    str.compare(str.size() - terminator.size(), terminator.size(), terminator) != 0)
+  {
+    int ch = get();
+    if (ch == eof)
+      throw(std::exception("ill-formed XML"));
+    append(str, ch);
+  }
+  str.erase(str.size() - terminator.size());
+  return str;
+}
+//----< replace predefined entities with the characters they stand for >-----
+
+std::string XmlParser::decode(const std::string& src)
+{
+  static const std::pair<const char*, char> entities[] = {
+    { "&lt;", '<' }, { "&gt;", '>' }, { "&amp;", '&' }, { "&quot;", '\"' }, { "&apos;", '\'' }
+  };
+  if (src.find('&') == std::string::npos)
+    return src;
+  std::string dst;
+  for (size_t i = 0; i < src.size(); ++i)
+  {
+    char ch = src[i];
+    for (auto& entity : entities)
+    {
+      size_t length = strlen(entity.first);
+      if (src.compare(i, length, entity.first) == 0)
+      {
+        ch = entity.second;
+        i += length - 1;
+        break;
+      }
+    }
+    dst.push_back(ch);
+  }
+  return dst;
+}
+//----< read start tag and its attributes, after the "<" >-------------------
+/*
+ *  - an empty element, e.g., <tag/>, is followed by its endElement
+ */
+void XmlParser::readStartTag(Event& event)
+{
+  event.type = startElement;
+  event.tag = readName();
+  if (event.tag.empty())
+    throw(std::exception("ill-formed XML"));
+  while (true)
+  {
+    skipSpace();
+    int ch = peek();
+    if (ch == '>' || ch == '/')
+    {
+      get();
+      if (ch == '/' && get() != '>')
+        throw(std::exception("ill-formed XML"));
+      closeEmpty_ = (ch == '/');
+      break;
+    }
+    std::string name = readName();
+    skipSpace();
+    if (name.empty() || get() != '=')
+      throw(std::exception("ill-formed XML"));
+    skipSpace();
+    int quote = get();
+    if (quote != '\"' && quote != '\'')
+      throw(std::exception("ill-formed XML"));
+    std::string value = readUntil(std::string(1, static_cast<char>(quote)));
+    event.attributes.push_back(attrib(name, decode(value)));
+  }
+  openTags_.push_back(event.tag);
+}
+//----< read end tag, after the "</", which must close the open element >----
+
+void XmlParser::readEndTag(Event& event)
+{
+  event.type = endElement;
+  event.tag = readName();
+  skipSpace();
+  if (get() != '>' || openTags_.empty() || openTags_.back() != event.tag)
+    throw(std::exception("ill-formed XML"));
+  openTags_.pop_back();
+}
+//----< read rest of text, returns false if it is only whitespace >----------
+
+bool XmlParser::readText(Event& event)
+{
+  while (peek() != eof && peek() != '<')
+    append(event.text, get());
+  size_t first = 0;
+  size_t last = event.text.size();
+  while (first < last && isspace(static_cast<unsigned char>(event.text[first])))
+    ++first;
+  while (last > first && isspace(static_cast<unsigned char>(event.text[last - 1])))
+    --last;
+  if (first == last)
+  {
+    event.text.clear();
+    return false;
+  }
+  event.type = text;
+  event.text = decode(event.text.substr(first, last - first));
+  return true;
+}
+//----< return next event, or false at the end of the document >-------------
+/*
+ *  - throws if the document is ill-formed, e.g., tags don't match
+ */
+bool XmlParser::next(Event& event)
+{
+  event.tag.clear();
+  event.attributes.clear();
+  event.text.clear();
+  if (closeEmpty_)
+  {
+    closeEmpty_ = false;
+    event.type = endElement;
+    event.tag = openTags_.back();
+    openTags_.pop_back();
+    return true;
+  }
+  while (true)
+  {
+    int ch = get();
+    if (ch == eof)
+    {
+      if (!openTags_.empty())
+        throw(std::exception("ill-formed XML"));
+      return false;
+    }
+    if (ch != '<')
+    {
+      append(event.text, ch);
+      if (readText(event))
+        return true;
+      continue;
+    }
+    ch = peek();
+    if (ch == '/')
+    {
+      get();
+      readEndTag(event);
+      return true;
+    }
+    if (ch == '?')
+    {
+      skipPast("?>");
+      continue;
+    }
+    if (ch == '!')
+    {
+      get();
+      if (peek() == '[')
+      {
+        skipPast("[CDATA[");
+        event.type = text;
+        event.text = readUntil("]]>");
+        if (!event.text.empty())
+          return true;
+        continue;
+      }
+      skipPast(peek() == '-' ? "-->" : ">");
+      continue;
+    }
+    readStartTag(event);
+    return true;
+  }
+}
 
 #ifdef TEST_XMLPARSER
 
@@ -384,6 +646,24 @@ int main()
   XmlDocument* pDoc = parser.buildDocument();
   Utils::title("Resulting XML Parse Tree:");
   std::cout << "\n" << pDoc->toString();
+
+  Utils::title("Streaming events, read through a 16 byte buffer:");
+  std::ifstream in(src);
+  XmlParser streamer(in, 16);
+  XmlParser::Event event;
+  while (streamer.next(event))
+  {
+    if (event.type == XmlParser::startElement)
+    {
+      std::cout << "\n  start element " << event.tag;
+      for (auto& item : event.attributes)
+        std::cout << ", " << item.first << " = " << item.second;
+    }
+    else if (event.type == XmlParser::text)
+      std::cout << "\n  text          " << event.text;
+    else
+      std::cout << "\n  end element   " << event.tag;
+  }
   std::cout << "\n\n";
 }
 
@@ -23,6 +23,15 @@
 *
 * XmlParser objects throw if given an invalid path to an XML file.
 *
+* An XmlParser constructed with a std::istream doesn't build an AST.
+* It reads the stream through a fixed size buffer and next() returns
+* one event at a time: startElement, with the tag and attributes,
+* text, and endElement.  Text is trimmed, entities are replaced, and
+* whitespace between elements, comments, declarations, and processing
+* instructions are skipped.  Memory is bounded by the buffer, the
+* nesting depth, and the largest tag or text, so arbitrarily large
+* documents can be read, e.g., by Persist<P>::fromXml.
+*
 * Build Process:
 * ---------------
 * - Required files: XmlParser.h, XmlParser.cpp, XmlElementParts.h, XmlElementParts.cpp,
@@ -32,6 +41,8 @@ XmlElement.cpp,ITokenCollection.h, Tokenizer.h, Tokenizer.cpp
 *
 * Maintenance History:
 *  --------------------
+*  ver 1.1 : 17th October 2026
+*  - added streaming mode, with a pull event API
 *  ver 1.0 : 4th Feb 2018
 *  - first release
 */
@@ -42,6 +53,7 @@ XmlElement.cpp,ITokenCollection.h, Tokenizer.h, Tokenizer.cpp
 #include <vector>
 #include <stack>
 #include <memory>
+#include <istream>
 
 namespace XmlProcessing
 {
@@ -56,11 +68,35 @@ namespace XmlProcessing
     using ElemStack = std::stack < sPtr > ;
 
     enum sourceType { file, str };
+    enum EventType { startElement, text, endElement };
+    struct Event
+    {
+      EventType type;
+      std::string tag;
+      attribs attributes;
+      std::string text;
+    };
+    static const size_t BufferSize = 64 * 1024;
+    static const size_t MaxTextSize = 64 * 1024 * 1024;
+
     XmlParser(const std::string& src, sourceType type = file);
+    XmlParser(std::istream& in, size_t bufferSize = BufferSize);
     bool good();
     XmlDocument* buildDocument();
+    bool next(Event& event);
     bool verbose(bool verb = true);
   private:
+    int get();
+    int peek();
+    void append(std::string& str, int ch);
+    void skipPast(const std::string& terminator);
+    void skipSpace();
+    std::string readName();
+    std::string readUntil(const std::string& terminator);
+    std::string decode(const std::string& src);
+    void readStartTag(Event& event);
+    void readEndTag(Event& event);
+    bool readText(Event& event);
     std::string textFileToString(const std::string& fileSpec);
     void compress(std::string& xmlStr);
     std::string enquoteText(const std::string& src);
@@ -77,12 +113,18 @@ namespace XmlProcessing
     void showAttributes();
     attribs& attributes();
     attribs attribs_;
-    ITokCollection* pTokColl_;
-    XmlParts* pXmlParts_;
+    ITokCollection* pTokColl_ = nullptr;
+    XmlParts* pXmlParts_ = nullptr;
     Toker* pToker_ = nullptr;
     std::string src_;
     bool verbose_ = false;
     bool good_ = false;
+    std::istream* pIn_ = nullptr;
+    std::vector<char> buffer_;
+    size_t bufPos_ = 0;
+    size_t bufEnd_ = 0;
+    std::vector<std::string> openTags_;
+    bool closeEmpty_ = false;
   };
 
   inline bool XmlParser::good() { return good_; }
@@ -0,0 +1,160 @@
+#ifndef XMLWRITER_H
+#define XMLWRITER_H
+/////////////////////////////////////////////////////////////////////////
+// XmlWriter.h - write XML markup directly to a stream                 //
+//                                                                     //
+// Author: Naga Rama Krishna, nrchalam@syr.edu                         //
+// Reference: Jim Fawcett                                              //
+// Application: NoSQL Database                                         //
+// Environment: C++ console                                            //
+// Platform: Lenovo T460                                               //
+// Operating System: Windows 10                                        //
+/////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides the XmlWriter class, which writes elements to
+* a std::ostream as they are started and ended, without building an
+* XmlDocument.  It keeps only the tags of open elements.
+* - start(tag) opens an element, attribute(name, value) adds to the
+*   element just started, text(text) adds a text child, and end()
+*   closes the innermost open element.
+* - element(tag, text) writes an element holding text, if any.
+* - text and attribute values are escaped, so "&", "<", and ">", and
+*   quotes in attributes, are written as entities.
+* Output is laid out like XmlDocument::toString: each tag and text
+* starts a new line, indented tabSize spaces per level, starting with
+* one level, and an element without children is written as a start
+* tag and an end tag on the next line.
+*
+* Build Process:
+* ---------------
+* - Required files: XmlWriter.h
+*
+* Maintenance History:
+*  --------------------
+*  ver 1.0 : 17th October 2026
+*  - first release
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <exception>
+
+namespace XmlProcessing
+{
+  class XmlWriter
+  {
+  public:
+    explicit XmlWriter(std::ostream& out, size_t tabSize = 2) : pOut_(&out), tabSize_(tabSize) {}
+
+    XmlWriter& start(const std::string& tag);
+    XmlWriter& attribute(const std::string& name, const std::string& value);
+    XmlWriter& text(const std::string& text);
+    XmlWriter& end();
+    XmlWriter& element(const std::string& tag, const std::string& text);
+    size_t depth() { return open_.size(); }
+    static void escape(std::ostream& out, const std::string& text, bool inAttribute = false);
+  private:
+    void closeStartTag();
+    void newLine(size_t level);
+
+    std::ostream* pOut_;
+    size_t tabSize_;
+    std::vector<std::string> open_;
+    bool inStartTag_ = false;
+  };
+  //----< open element, attributes may follow >------------------------------
+
+  inline XmlWriter& XmlWriter::start(const std::string& tag)
+  {
+    closeStartTag();
+    open_.push_back(tag);
+    newLine(open_.size());
+    *pOut_ << '<' << tag;
+    inStartTag_ = true;
+    return *this;
+  }
+  //----< add attribute to element just started >----------------------------
+
+  inline XmlWriter& XmlWriter::attribute(const std::string& name, const std::string& value)
+  {
+    if (!inStartTag_)
+      throw(std::exception("XML attribute written after element content"));
+    *pOut_ << ' ' << name << "=\"";
+    escape(*pOut_, value, true);
+    pOut_->put('"');
+    return *this;
+  }
+  //----< add text child to innermost open element >-------------------------
+
+  inline XmlWriter& XmlWriter::text(const std::string& text)
+  {
+    closeStartTag();
+    newLine(open_.size() + 1);
+    escape(*pOut_, text);
+    return *this;
+  }
+  //----< close innermost open element >-------------------------------------
+
+  inline XmlWriter& XmlWriter::end()
+  {
+    if (open_.empty())
+      throw(std::exception("no XML element to end"));
+    closeStartTag();
+    newLine(open_.size());
+    *pOut_ << "</" << open_.back() << '>';
+    open_.pop_back();
+    return *this;
+  }
+  //----< write element holding text, empty text adds no child >-------------
+
+  inline XmlWriter& XmlWriter::element(const std::string& tag, const std::string& text)
+  {
+    start(tag);
+    if (text.size() > 0)
+      this->text(text);
+    return end();
+  }
+  //----< write text, replacing markup characters with entities >------------
+
+  inline void XmlWriter::escape(std::ostream& out, const std::string& text, bool inAttribute)
+  {
+    const char* special = inAttribute ? "&<>\"" : "&<>";
+    size_t done = 0;
+    size_t pos = text.find_first_of(special);
+    while (pos != std::string::npos)
+    {
+      out.write(text.data() + done, pos - done);
+      switch (text[pos])
+      {
+      case '&': out << "&amp;"; break;
+      case '<': out << "&lt;"; break;
+      case '>': out << "&gt;"; break;
+      default: out << "&quot;"; break;
+      }
+      done = pos + 1;
+      pos = text.find_first_of(special, done);
+    }
+    out.write(text.data() + done, text.size() - done);
+  }
+  //----< end start tag, once its attributes are written >-------------------
+
+  inline void XmlWriter::closeStartTag()
+  {
+    if (!inStartTag_)
+      return;
+    pOut_->put('>');
+    inStartTag_ = false;
+  }
+  //----< start new line indented to level >---------------------------------
+
+  inline void XmlWriter::newLine(size_t level)
+  {
+    pOut_->put('\n');
+    for (size_t i = 0; i < tabSize_ * level; ++i)
+      pOut_->put(' ');
+  }
+}
+#endif
@@ -1,3 +1,3 @@
 start GUI\bin\x86\Debug\WpfApp1.exe 8082
 start GUI\bin\x86\Debug\WpfApp1.exe 8083
-start Debug/ServerPrototype.exe /n2 *.h *.cpp
\ No newline at end of file
+start Debug/ServerPrototype.exe /d /demo /n2 *.h *.cpp
\ No newline at end of file